@@ -0,0 +1,65 @@
+# Build helpers shared by the solver, interface and planner targets.
+
+include(CheckIPOSupported)
+
+if(FAST_MPC_LTO)
+  check_ipo_supported(RESULT FAST_MPC_IPO_SUPPORTED OUTPUT FAST_MPC_IPO_MESSAGE LANGUAGES C CXX)
+  if(NOT FAST_MPC_IPO_SUPPORTED)
+    message(STATUS "fast_mpc: link-time optimization not supported: ${FAST_MPC_IPO_MESSAGE}")
+  endif()
+endif()
+
+# ISA variants only exist for x86 with GCC-compatible compilers.
+set(FAST_MPC_DISPATCH_SUPPORTED OFF)
+if(FAST_MPC_CPU_DISPATCH
+   AND CMAKE_C_COMPILER_ID MATCHES "GNU|Clang"
+   AND CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64|amd64|i.86")
+  set(FAST_MPC_DISPATCH_SUPPORTED ON)
+endif()
+
+# fast_mpc_isa_flags(<variant> <out_var>)
+# Compiler flags of one ISA variant; "generic" is the baseline of the target.
+function(fast_mpc_isa_flags variant out_var)
+  if(variant STREQUAL "generic")
+    set(flags "")
+  elseif(variant STREQUAL "avx")
+    set(flags -mavx)
+  elseif(variant STREQUAL "avx2")
+    set(flags -mavx2 -mfma)
+  elseif(variant STREQUAL "avx512")
+    set(flags -mavx512f -mavx512dq -mavx2 -mfma)
+  else()
+    message(FATAL_ERROR "fast_mpc: unknown ISA variant '${variant}'")
+  endif()
+  set(${out_var} ${flags} PARENT_SCOPE)
+endfunction()
+
+# fast_mpc_optimize(<target>...)
+# Applies link-time and profile-guided optimization to the given targets.
+function(fast_mpc_optimize)
+  foreach(target IN LISTS ARGN)
+    if(FAST_MPC_LTO AND FAST_MPC_IPO_SUPPORTED)
+      set_property(TARGET ${target} PROPERTY INTERPROCEDURAL_OPTIMIZATION TRUE)
+    endif()
+
+    if(FAST_MPC_PGO STREQUAL "GENERATE")
+      if(CMAKE_C_COMPILER_ID MATCHES "Clang")
+        set(pgo_flags "-fprofile-generate=${FAST_MPC_PGO_DIR}")
+      else()
+        set(pgo_flags "-fprofile-generate" "-fprofile-dir=${FAST_MPC_PGO_DIR}" "-fprofile-update=atomic")
+      endif()
+      target_compile_options(${target} PRIVATE ${pgo_flags})
+      target_link_options(${target} PRIVATE ${pgo_flags})
+    elseif(FAST_MPC_PGO STREQUAL "USE")
+      if(CMAKE_C_COMPILER_ID MATCHES "Clang")
+        set(pgo_flags "-fprofile-use=${FAST_MPC_PGO_DIR}/default.profdata" "-Wno-profile-instr-unprofiled")
+      else()
+        set(pgo_flags "-fprofile-use" "-fprofile-dir=${FAST_MPC_PGO_DIR}" "-fprofile-correction" "-Wno-missing-profile")
+      endif()
+      target_compile_options(${target} PRIVATE ${pgo_flags})
+      target_link_options(${target} PRIVATE ${pgo_flags})
+    elseif(NOT FAST_MPC_PGO STREQUAL "OFF")
+      message(FATAL_ERROR "fast_mpc: FAST_MPC_PGO must be OFF, GENERATE or USE")
+    endif()
+  endforeach()
+endfunction()
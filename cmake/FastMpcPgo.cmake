@@ -0,0 +1,61 @@
+# Profile-guided build of fast_mpc, run in script mode:
+#
+#   cmake [-DCORPUS="a.corpus;b.corpus"] [-DBUILD_DIR=_pgo_build]
+#         [-DCMAKE_C_COMPILER=clang] -P cmake/FastMpcPgo.cmake
+#
+# 1. configures and builds an instrumented tree (FAST_MPC_PGO=GENERATE),
+# 2. replays the recorded solver inputs of CORPUS through
+#    FORCESNLPsolver_replay (the built-in scenarios if CORPUS is empty),
+# 3. merges the raw profiles (Clang only) and
+# 4. rebuilds the same tree with the gathered profiles (FAST_MPC_PGO=USE).
+#
+# The same build directory is used for both builds, since GCC keys its
+# profiles by object file path. Everything runs offline.
+
+cmake_minimum_required(VERSION 3.18)
+
+get_filename_component(SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+if(NOT BUILD_DIR)
+  set(BUILD_DIR "${SOURCE_DIR}/_pgo_build")
+endif()
+get_filename_component(BUILD_DIR "${BUILD_DIR}" ABSOLUTE)
+set(PGO_DIR "${BUILD_DIR}/pgo")
+
+set(configure_args -S "${SOURCE_DIR}" -B "${BUILD_DIR}" -DCMAKE_BUILD_TYPE=Release "-DFAST_MPC_PGO_DIR=${PGO_DIR}")
+if(CMAKE_C_COMPILER)
+  list(APPEND configure_args "-DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}")
+endif()
+if(CMAKE_CXX_COMPILER)
+  list(APPEND configure_args "-DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}")
+endif()
+
+function(pgo_run)
+  execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "fast_mpc PGO: '${ARGN}' failed (${result})")
+  endif()
+endfunction()
+
+message(STATUS "fast_mpc PGO: instrumented build in ${BUILD_DIR}")
+file(REMOVE_RECURSE "${PGO_DIR}")
+file(MAKE_DIRECTORY "${PGO_DIR}")
+pgo_run(${CMAKE_COMMAND} ${configure_args} -DFAST_MPC_PGO=GENERATE)
+pgo_run(${CMAKE_COMMAND} --build "${BUILD_DIR}" --target FORCESNLPsolver_replay --parallel)
+
+message(STATUS "fast_mpc PGO: training run")
+set(corpus)
+foreach(file IN LISTS CORPUS)
+  get_filename_component(file "${file}" ABSOLUTE)
+  list(APPEND corpus "${file}")
+endforeach()
+pgo_run("${BUILD_DIR}/python_mpc/test/FORCESNLPsolver_replay" ${corpus})
+
+file(GLOB raw_profiles "${PGO_DIR}/*.profraw")
+if(raw_profiles)
+  find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+  pgo_run("${LLVM_PROFDATA}" merge -output "${PGO_DIR}/default.profdata" ${raw_profiles})
+endif()
+
+message(STATUS "fast_mpc PGO: optimized build")
+pgo_run(${CMAKE_COMMAND} ${configure_args} -DFAST_MPC_PGO=USE)
+pgo_run(${CMAKE_COMMAND} --build "${BUILD_DIR}" --clean-first --parallel)
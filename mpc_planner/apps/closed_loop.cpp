@@ -0,0 +1,83 @@
+/*
+ * Closed-loop simulation of the planner runtime, the C++ counterpart of the
+ * simulation loop in two_abstacles.m.
+ *
+ *   mpc_closed_loop [seconds] [multi-start workers] [solve log]
+ *
+ * A simulated plant on the control thread integrates the commanded ego inputs
+ * (obstacles keep their speed and heading) and feeds its state back to the
+ * runtime as the state estimate. The obstacles are also reported through the
+ * obstacle channel at a lower rate, as a perception module would. Given a
+ * solve log, all solves are recorded to it for mpc_solve_replay.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "mpc_planner/planner_runtime.h"
+#include "mpc_planner/vehicle_model.h"
+
+using namespace mpc_planner;
+
+int main(int argc, char** argv)
+{
+    double duration = argc > 1 ? std::atof(argv[1]) : 2.0;
+
+    PlannerConfig config;
+    config.multi_start_workers = argc > 2 ? std::atoi(argv[2]) : 0;
+    if (argc > 3) config.record_path = argv[3];
+    PlannerRuntime runtime(config);
+
+    /* initial condition of two_abstacles.m */
+    StateEstimate plant;
+    const double xinit[kStates] = { -1.5, 0, 0.5, kPi / 2, -1, 1.11, 0.1, kPi / 4, -2, 0, 0.5, kPi / 2 };
+    for (int i = 0; i < kStates; i++) plant.x[i] = xinit[i];
+    plant.stamp = PlannerRuntime::now();
+
+    long invalid = 0;
+    long ticks = 0;
+    const long perception_decimation = 5;
+    runtime.set_control_callback([&](const ControlCommand& command, const Trajectory&) {
+        double u[kInputs] = {};
+        if (command.valid) {
+            u[kForce] = command.u[kForce];
+            u[kSteer] = command.u[kSteer];
+        } else {
+            invalid++;
+        }
+        const double p[kStageParams] = { kMass, kInertia };
+        double x_next[kStates];
+        model_rk4(plant.x, u, p, config.control_period, x_next);
+        for (int i = 0; i < kStates; i++) plant.x[i] = x_next[i];
+        plant.stamp = command.stamp;
+        runtime.publish_state(plant);
+
+        if (ticks++ % perception_decimation == 0) {
+            ObstacleChannel& obstacles = runtime.obstacles();
+            for (int i = 0; i < kObstacles; i++) obstacles.update(i, plant.x + kCarStates * (i + 1));
+            obstacles.publish(command.stamp);
+        }
+    });
+
+    runtime.publish_state(plant);
+    if (!runtime.start()) {
+        std::fprintf(stderr, "cannot start the planner runtime\n");
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(duration));
+    runtime.stop();
+
+    const PlannerStats& stats = runtime.stats();
+    std::printf("solves %ld (failed %ld, emergency stops %ld, overruns %ld), control ticks %ld (without plan %ld, overruns %ld)\n",
+                stats.solves.load(), stats.failures.load(), stats.fallbacks.load(), stats.solver_overruns.load(),
+                stats.control_ticks.load(), invalid, stats.control_overruns.load());
+    if (const SolveRecorder* recorder = runtime.recorder()) {
+        std::printf("recorded %lu solves (dropped %lu)\n", recorder->recorded(), recorder->dropped());
+    }
+    std::printf("final ego state x=%.3f y=%.3f v=%.3f theta=%.3f\n",
+                plant.x[kX], plant.x[kY], plant.x[kV], plant.x[kTheta]);
+    return 0;
+}
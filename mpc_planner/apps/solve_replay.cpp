@@ -0,0 +1,96 @@
+/*
+ * Replay of a solve log written by SolveRecorder.
+ *
+ *   mpc_solve_replay log [--record N] [--corpus file]
+ *
+ * Solves every recorded instance (or only record N, counting from 0) again
+ * from its recorded FORCESNLPsolver_params and checks that exitflag and
+ * output are reproduced bit for bit. Solves that ran into their deadline
+ * (exitflag FORCESNLPsolver_BADFUNCEVAL with a deadline set) depended on the
+ * timing and are only counted. With --corpus the replayed instances are also
+ * appended to a scenario corpus with the recorded results as reference
+ * (FORCESNLPsolver_corpus.h), e.g. to add a field failure to a regression set.
+ *
+ * Exits with 1 if any solve differs.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "FORCESNLPsolver_corpus.h"
+#include "mpc_planner/solve_recorder.h"
+#include "mpc_planner/solver.h"
+
+using namespace mpc_planner;
+
+int main(int argc, char** argv)
+{
+    const char* path = nullptr;
+    const char* corpus = nullptr;
+    long only = -1;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--record") && i + 1 < argc) {
+            only = std::atol(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--corpus") && i + 1 < argc) {
+            corpus = argv[++i];
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "usage: %s log [--record N] [--corpus file]\n", argv[0]);
+        return 1;
+    }
+
+    SolveLogReader reader;
+    if (!reader.open(path)) {
+        std::fprintf(stderr, "%s\n", reader.error().c_str());
+        return 1;
+    }
+
+    Solver solver;
+    std::unique_ptr<SolveRecord> record(new SolveRecord);
+    long index = 0, replayed = 0, exact = 0, differ = 0, expired = 0;
+    for (; reader.next(record.get()); index++) {
+        if (only >= 0 && index != only) continue;
+        replayed++;
+
+        if (corpus && FORCESNLPsolver_corpus_append(corpus, &record->params, &record->output, record->exitflag,
+                                                    record->info.it) != FORCESNLPsolver_CORPUS_OK) {
+            std::fprintf(stderr, "cannot append to %s\n", corpus);
+            corpus = nullptr;
+        }
+
+        if (record->deadline > 0 && record->exitflag == FORCESNLPsolver_BADFUNCEVAL) {
+            expired++;
+            continue;
+        }
+        solver.params() = record->params;
+        int exitflag = solver.solve(record->params.xinit, nullptr);
+        if (exitflag == record->exitflag && !std::memcmp(&solver.output(), &record->output, sizeof(record->output))) {
+            exact++;
+            continue;
+        }
+        differ++;
+        const double* z = reinterpret_cast<const double*>(&solver.output());
+        const double* r = reinterpret_cast<const double*>(&record->output);
+        int first = 0;
+        while (first < kStages * kStageVars && !std::memcmp(z + first, r + first, sizeof(double))) first++;
+        std::printf("record %ld (stamp %.6f): exitflag %d, recorded %d", index, record->stamp, exitflag, record->exitflag);
+        if (first < kStages * kStageVars) {
+            std::printf("; output differs from stage %d variable %d", first / kStageVars, first % kStageVars);
+        }
+        std::printf("\n");
+    }
+
+    std::printf("replayed %ld of %ld records: %ld bit-exact, %ld differ, %ld cut by their deadline",
+                replayed, index, exact, differ, expired);
+    if (reader.skipped()) std::printf(", %lu damaged frames skipped", reader.skipped());
+    std::printf("\n");
+    return differ ? 1 : 0;
+}
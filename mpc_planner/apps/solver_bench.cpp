@@ -0,0 +1,274 @@
+/*
+ * Latency benchmark of the generated solvers.
+ *
+ *   mpc_solver_bench [--repeat N] [--perturbations N] [--phases] [--counters]
+ *
+ * Replays the initial conditions of two_abstacles.m and dynamic_obstacle.m,
+ * each with deterministic perturbations, through FORCESNLPsolver_solve, and
+ * a grid of initial states of the double integrator of FORCESpro_simplempc.m
+ * through myMPC_FORCESPro_solve. Every instance is solved --repeat times from
+ * the same initial guess. Prints one JSON object per solver with wall-clock
+ * latency percentiles, iterations, the share of solve time spent in function
+ * evaluations (NLP only) and a histogram of the exitflags.
+ *
+ * The latencies are measured without instrumentation. --phases adds a
+ * separate pass that solves every NLP instance once more with
+ * IterationTelemetry and reports the mean time per solve of each phase;
+ * --counters adds the hardware counters of each phase to that pass
+ * (perf_counters.h; needs perf_event_paranoid <= 2 or CAP_PERFMON).
+ *
+ * dynamic_obstacle.m has a single obstacle; the second obstacle of
+ * FORCESNLPsolver is parked at standstill on its lane opposite the ego car.
+ *
+ * Both generated objects carry the same FORCES runtime symbols, so
+ * myMPC_FORCESPro is loaded from its shared library with dlopen rather than
+ * linked.
+ */
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+extern "C" {
+#include "myMPC_FORCESPro.h"
+}
+
+#include "mpc_planner/iteration_telemetry.h"
+#include "mpc_planner/solver.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchResult {
+    std::vector<double> latency;  /* wall clock per solve, seconds */
+    long iterations = 0;
+    int max_iterations = 0;
+    double solvetime = 0;
+    double fevalstime = 0;
+    /* instrumented pass */
+    long phase_solves = 0;
+    PhaseTimes phases;
+    PhaseCounters counters;
+    bool counted = false;
+    std::map<int, long> exitflags;
+
+    void add(double seconds, int exitflag, int it)
+    {
+        latency.push_back(seconds);
+        exitflags[exitflag]++;
+        iterations += it;
+        max_iterations = std::max(max_iterations, it);
+    }
+};
+
+/* nearest-rank percentile of sorted VALUES */
+double percentile(const std::vector<double>& values, double p)
+{
+    if (values.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100 * values.size() + 0.5);
+    return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+/* uniform in [-0.5, 0.5), reproducible */
+double perturbation(unsigned* seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return static_cast<double>((*seed >> 16) & 0x7fff) / 0x8000 - 0.5;
+}
+
+void print_counters(const char* name, const CounterValues& counts, double n, bool last)
+{
+    std::printf("      \"%s\": {", name);
+    for (int i = 0; i < kPerfEvents; i++) {
+        std::printf("%s\"%s\": %.1f", i ? ", " : " ", PerfCounters::name(static_cast<PerfEvent>(i)), counts.value[i] / n);
+    }
+    std::printf(" }%s\n", last ? "" : ",");
+}
+
+void print_result(const char* name, BenchResult& result, bool fevals, bool last)
+{
+    std::vector<double>& latency = result.latency;
+    std::sort(latency.begin(), latency.end());
+    const double n = latency.empty() ? 1 : static_cast<double>(latency.size());
+
+    std::printf("  \"%s\": {\n", name);
+    std::printf("    \"solves\": %zu,\n", latency.size());
+    std::printf("    \"latency_ms\": { \"p50\": %.6f, \"p99\": %.6f, \"max\": %.6f },\n",
+                1e3 * percentile(latency, 50), 1e3 * percentile(latency, 99),
+                latency.empty() ? 0.0 : 1e3 * latency.back());
+    std::printf("    \"iterations\": { \"mean\": %.3f, \"max\": %d },\n", result.iterations / n, result.max_iterations);
+    if (fevals) {
+        std::printf("    \"fevals_share\": %.6f,\n", result.solvetime > 0 ? result.fevalstime / result.solvetime : 0.0);
+    }
+    if (result.phase_solves) {
+        const double m = static_cast<double>(result.phase_solves);
+        std::printf("    \"phases_ms\": { \"feval\": %.6f, \"factor\": %.6f, \"linesearch\": %.6f },\n",
+                    1e3 * result.phases.feval / m, 1e3 * result.phases.factor / m, 1e3 * result.phases.linesearch / m);
+        if (result.counted) {
+            std::printf("    \"counters\": {\n");
+            print_counters("feval", result.counters.feval, m, false);
+            print_counters("factor", result.counters.factor, m, false);
+            print_counters("linesearch", result.counters.linesearch, m, true);
+            std::printf("    },\n");
+        }
+    }
+    std::printf("    \"exitflags\": {");
+    const char* separator = " ";
+    for (const auto& entry : result.exitflags) {
+        std::printf("%s\"%d\": %ld", separator, entry.first, entry.second);
+        separator = ", ";
+    }
+    std::printf(" }\n  }%s\n", last ? "" : ",");
+}
+
+void bench_nlp(int repeat, int perturbations, bool phases, bool counters, BenchResult* result)
+{
+    /* two_abstacles.m (both initial conditions) and dynamic_obstacle.m */
+    static const double scenarios[][kStates] = {
+        { -1.5, 0, 0.55, kPi / 2, -1, 1.11, 0.1, kPi / 4, -2, 0, 0.5, kPi / 2 },
+        { -1.5, 0, 0.5, kPi / 2, -1, 1.11, 0.1, kPi / 4, -2, 0, 0.5, kPi / 2 },
+        { -1.5, 0, 0.4, kPi / 2, -1, 1.11, 0.1, kPi / 4, 2, 0, 0, -kPi / 2 },
+    };
+    std::vector<std::vector<double>> instances;
+    unsigned seed = 1;
+    for (const auto& scenario : scenarios) {
+        for (int r = 0; r <= perturbations; r++) {
+            std::vector<double> xinit(kStates);
+            for (int i = 0; i < kStates; i++) xinit[i] = scenario[i] + (r ? 0.02 * perturbation(&seed) : 0);
+            instances.push_back(xinit);
+        }
+    }
+
+    Solver solver;
+    ExtendedInfo info;
+    Trajectory* out = new Trajectory;
+
+    /* latency, without telemetry */
+    for (const auto& xinit : instances) {
+        for (int n = 0; n < repeat; n++) {
+            solver.reset();
+            Clock::time_point start = Clock::now();
+            int exitflag = solver.solve(xinit.data(), out);
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            solver.extended_info(&info);
+            result->add(seconds, exitflag, info.info.it);
+            result->solvetime += info.info.solvetime;
+            result->fevalstime += info.info.fevalstime;
+        }
+    }
+
+    /* phases, in a separate instrumented pass */
+    if (phases || counters) {
+        IterationTelemetry* telemetry = new IterationTelemetry;
+        solver.set_telemetry(telemetry);
+        PerfCounters perf;
+        if (counters) {
+            if (perf.open()) {
+                telemetry->set_counters(&perf);
+            } else {
+                std::fprintf(stderr, "hardware counters unavailable\n");
+            }
+        }
+        for (const auto& xinit : instances) {
+            solver.reset();
+            solver.solve(xinit.data(), out);
+            solver.extended_info(&info);
+            result->phase_solves++;
+            result->phases.feval += info.time.feval;
+            result->phases.factor += info.time.factor;
+            result->phases.linesearch += info.time.linesearch;
+            result->counters.feval += info.counters.feval;
+            result->counters.factor += info.counters.factor;
+            result->counters.linesearch += info.counters.linesearch;
+            result->counted = info.counted;
+        }
+        solver.set_telemetry(nullptr);
+        delete telemetry;
+    }
+    delete out;
+}
+
+using LinearSolve = int (*)(myMPC_FORCESPro_params*, myMPC_FORCESPro_output*, myMPC_FORCESPro_info*, std::FILE*);
+
+void bench_linear(LinearSolve solve, int repeat, int perturbations, BenchResult* result, std::FILE* log)
+{
+    /* x+ = A x + B u of FORCESpro_simplempc.m; the solver takes -A*x0 */
+    static const double A[2][2] = { { 1.1, 1 }, { 0, 1 } };
+    static const double states[][2] = { { 0, 0 }, { 1, 1 }, { -2, 1 }, { 3, -1 }, { -4, -2 } };
+    myMPC_FORCESPro_params params;
+    myMPC_FORCESPro_output output;
+    myMPC_FORCESPro_info info;
+    unsigned seed = 2;
+
+    for (const auto& state : states) {
+        for (int r = 0; r <= perturbations; r++) {
+            double x[2] = { state[0] + (r ? 0.2 * perturbation(&seed) : 0),
+                            state[1] + (r ? 0.2 * perturbation(&seed) : 0) };
+            params.minusA_times_x0[0] = -(A[0][0] * x[0] + A[0][1] * x[1]);
+            params.minusA_times_x0[1] = -(A[1][0] * x[0] + A[1][1] * x[1]);
+
+            for (int n = 0; n < repeat; n++) {
+                Clock::time_point start = Clock::now();
+                int exitflag = solve(&params, &output, &info, log);
+                double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+                result->add(seconds, exitflag, info.it);
+                result->solvetime += info.solvetime;
+            }
+        }
+    }
+}
+
+}  /* namespace */
+
+int main(int argc, char** argv)
+{
+    int repeat = 5;
+    int perturbations = 8;
+    bool phases = false;
+    bool counters = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--repeat") && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--perturbations") && i + 1 < argc) {
+            perturbations = std::max(0, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--phases")) {
+            phases = true;
+        } else if (!std::strcmp(argv[i], "--counters")) {
+            counters = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--repeat N] [--perturbations N] [--phases] [--counters]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    void* library = dlopen(MPC_PLANNER_MYMPC_LIBRARY, RTLD_NOW | RTLD_LOCAL);
+    LinearSolve linear_solve = library ? reinterpret_cast<LinearSolve>(dlsym(library, "myMPC_FORCESPro_solve")) : nullptr;
+    if (!linear_solve) {
+        std::fprintf(stderr, "cannot load %s\n", MPC_PLANNER_MYMPC_LIBRARY);
+        return 1;
+    }
+
+    std::FILE* log = std::fopen("/dev/null", "w");
+    BenchResult nlp, linear;
+    bench_nlp(repeat, perturbations, phases, counters, &nlp);
+    bench_linear(linear_solve, repeat, perturbations, &linear, log);
+    if (log) std::fclose(log);
+    dlclose(library);
+
+    std::printf("{\n");
+    print_result("FORCESNLPsolver", nlp, true, false);
+    print_result("myMPC_FORCESPro", linear, false, true);
+    std::printf("}\n");
+    return 0;
+}
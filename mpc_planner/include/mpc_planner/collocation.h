@@ -0,0 +1,66 @@
+/*
+ * Implicit collocation integrators for the stage dynamics.
+ *
+ * An s-point collocation method integrates dx/dt = f(x, u) over a step h with
+ * u held through the stage derivatives K_1..K_s that solve
+ *   K_i = f(x + h sum_j a_ij K_j, u),   x+ = x + h sum_i b_i K_i
+ * Gauss-Legendre with s points has order 2s, Radau IIA order 2s-1 and is
+ * stiffly accurate. Against the order 4 of RK4, a 3-point Gauss-Legendre step
+ * reaches the same accuracy with far longer steps, i.e. fewer stages.
+ *
+ * The collocation equations are solved by Newton's method from K_i = f(x, u)
+ * with the dense matrix M = I - h (A (x) J) factorized by LU. The
+ * sensitivities of x+ follow from the implicit function theorem with M of the
+ * converged iterate, dK/d(x, u) = M^-1 [J_i B_i], and are exact for the
+ * discrete map. K stays local to the step: the solver sees the same stage
+ * variables and c(z) = E z+ as with RK4.
+ */
+
+#ifndef MPC_PLANNER_COLLOCATION_H
+#define MPC_PLANNER_COLLOCATION_H
+
+#include "mpc_planner/ego_problem.h"
+#include "mpc_planner/problem.h"
+
+namespace mpc_planner {
+
+enum class Collocation { kGaussLegendre2, kGaussLegendre3, kRadauIIA3 };
+
+constexpr int kMaxCollocationPoints = 3;
+
+struct CollocationConfig {
+    Collocation method = Collocation::kGaussLegendre3;
+
+    /* Newton stops once the largest update of K is below this */
+    double tolerance = 1e-12;
+    int max_iterations = 10;
+};
+
+/* order of accuracy of METHOD */
+int collocation_order(Collocation method);
+
+/*
+ * One step of one car from X with inputs U. Writes x+ to X_NEXT and, unless
+ * nullptr, its sensitivities DX (d x+/dx) and DU (d x+/du). Returns false if
+ * Newton did not converge; X_NEXT then holds the last iterate.
+ */
+bool car_collocation(const CollocationConfig& config, const double x[kCarStates], const double u[kCarInputs],
+                     double m, double I, double h, double x_next[kCarStates],
+                     double dx[kCarStates][kCarStates] = nullptr, double du[kCarStates][kCarInputs] = nullptr);
+
+/*
+ * Dynamics of an ego stage in the layout of the external function
+ * (FORCESNLPsolver_ExtFunc, see ego_problem.h): Z = [F s x y v theta],
+ * P = [m I ...], C = x+ and NABLA_C its 4 x 6 Jacobian w.r.t. z, column
+ * major. Either output may be nullptr.
+ */
+bool ego_collocation(const CollocationConfig& config, const double z[kEgoStageVars], const double* p, double h,
+                     double c[kCarStates], double nabla_c[kCarStates * kEgoStageVars]);
+
+/* one step of the full model (ego and obstacles), P = [m I]; the counterpart of model_rk4 */
+bool model_collocation(const CollocationConfig& config, const double x[kStates], const double u[kInputs],
+                       const double p[kStageParams], double h, double x_next[kStates]);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_COLLOCATION_H */
@@ -0,0 +1,108 @@
+/*
+ * Signed distance field of an occupancy grid, for clearance constraints.
+ *
+ * The analytic ellipses of two_abstacles.m need one constraint per modeled
+ * agent. Static clutter (parked cars, road edges from a map) is rasterized
+ * into an occupancy grid instead, and the signed distance to it, positive in
+ * free space and negative inside obstacles, gives a single clearance row of h
+ * per stage against all of it.
+ *
+ * The field holds exact Euclidean distances between cell centres, clamped to
+ * max_distance. A cell's clamped distance only depends on the occupancy
+ * within max_distance of it, so after cells change, update() recomputes the
+ * box around the changes grown by max_distance, from the occupancy in that
+ * box grown once more. Distances are stored as float in 8 x 8 tiles: the
+ * four cells of a bilinear lookup share a tile most of the time and the
+ * lookups of a horizon, which follow a path, touch a few dozen tiles.
+ *
+ * Updates and lookups are not synchronized; update between solves.
+ */
+
+#ifndef MPC_PLANNER_DISTANCE_FIELD_H
+#define MPC_PLANNER_DISTANCE_FIELD_H
+
+#include <cstdint>
+#include <vector>
+
+#include "mpc_planner/ego_problem.h"
+
+namespace mpc_planner {
+
+struct DistanceFieldConfig {
+    /* corner of cell (0, 0) and cell size, m */
+    double origin_x = -5;
+    double origin_y = -5;
+    double resolution = 0.05;
+
+    /* cells */
+    int width = 200;
+    int height = 200;
+
+    /* distances saturate here, m; bounds the region an update touches */
+    double max_distance = 2;
+};
+
+class DistanceField {
+public:
+    /* allocates a free grid; returns false for an empty grid or a non-positive resolution */
+    bool init(const DistanceFieldConfig& config);
+
+    const DistanceFieldConfig& config() const { return config_; }
+
+    /* changes the occupancy of cell (I, J) or of the cell at (X, Y); cells outside are ignored */
+    void set_occupied(int i, int j, bool occupied);
+    void set_occupied_at(double x, double y, bool occupied);
+    bool occupied(int i, int j) const;
+
+    /* brings the distances up to date with the occupancy; returns the number of cells recomputed */
+    long update();
+
+    /* signed distance stored for cell (I, J), m */
+    double cell(int i, int j) const { return sdf_[index(i, j)]; }
+
+    /*
+     * Signed distance at (X, Y), bilinear between the cell centres, and its
+     * gradient GRAD unless nullptr. Outside the grid: max_distance, gradient 0.
+     */
+    double distance(double x, double y, double grad[2] = nullptr) const;
+
+private:
+    static constexpr int kTileBits = 3;
+    static constexpr int kTileSize = 1 << kTileBits;
+    static constexpr int kTileMask = kTileSize - 1;
+
+    int index(int i, int j) const
+    {
+        return (((j >> kTileBits) * tiles_x_ + (i >> kTileBits)) << (2 * kTileBits)) +
+               ((j & kTileMask) << kTileBits) + (i & kTileMask);
+    }
+
+    /* squared cell distances to the nearest cell of occupancy TARGET within the window */
+    void transform(bool target, int i0, int j0, int w, int h, std::vector<double>& out);
+
+    DistanceFieldConfig config_;
+    int tiles_x_ = 0;
+    int reach_ = 0;  /* max_distance in cells, rounded up */
+    std::vector<std::uint8_t> occupancy_;  /* row major */
+    std::vector<float> sdf_;               /* tiled */
+
+    /* box of the cells changed since the last update, empty if dirty_i0_ > dirty_i1_ */
+    int dirty_i0_ = 0, dirty_i1_ = -1, dirty_j0_ = 0, dirty_j1_ = -1;
+
+    /* preallocated for update */
+    std::vector<double> to_occupied_, to_free_, line_, envelope_;
+    std::vector<int> vertices_;
+};
+
+/*
+ * Clearance of an ego stage in the layout of the external function (see
+ * ego_problem.h), as row ROW of the NH inequalities: h[ROW] = distance at
+ * (x, y) and its entries of the column-major NABLA_H. Either may be nullptr.
+ * The safety radius goes into model.hl.
+ */
+void ego_clearance(const DistanceField& field, const double z[kEgoStageVars], int row, int nh, double* h,
+                   double* nabla_h);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_DISTANCE_FIELD_H */
@@ -0,0 +1,48 @@
+/*
+ * Problem layout of FORCESNLPsolver_ego, as generated by two_obstacles_ego.m.
+ *
+ * Only the ego car is optimized; each of the kStages stages holds
+ *   z = [F s | x y v theta]
+ * and the obstacles enter through the stage parameters
+ *   p = [m I | x1 y1 theta1 | x2 y2 theta2 | ...]
+ * i.e. the physical constants of the ego car followed by the predicted pose
+ * of each obstacle slot at the time of the stage.
+ */
+
+#ifndef MPC_PLANNER_EGO_PROBLEM_H
+#define MPC_PLANNER_EGO_PROBLEM_H
+
+#include "mpc_planner/problem.h"
+
+namespace mpc_planner {
+
+constexpr int kEgoStageVars = kCarInputs + kCarStates;   /* model.nvar */
+constexpr int kObstacleSlots = 2;                        /* obstacle poses per stage */
+constexpr int kPoseParams = 3;                           /* x y theta */
+constexpr int kParamMass = 0;
+constexpr int kParamInertia = 1;
+constexpr int kParamObstacles = 2;                       /* first pose parameter */
+constexpr int kEgoStageParams = kParamObstacles + kPoseParams * kObstacleSlots;  /* model.npar */
+
+/* obstacle pose within its slot */
+enum PoseIndex { kPoseX = 0, kPoseY = 1, kPoseTheta = 2 };
+
+/* model.lb / model.ub */
+constexpr double kEgoLowerBounds[kEgoStageVars] = { -5, -1, -3, -1, 0, -kPi };
+constexpr double kEgoUpperBounds[kEgoStageVars] = { +5, +1, 3, 3, 1, +kPi };
+
+/* parameters of stage K within all_parameters */
+inline double* ego_stage_params(double* all_parameters, int k)
+{
+    return all_parameters + kEgoStageParams * k;
+}
+
+/* pose of obstacle SLOT within the parameters of one stage */
+inline double* obstacle_pose(double* stage_params, int slot)
+{
+    return stage_params + kParamObstacles + kPoseParams * slot;
+}
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_EGO_PROBLEM_H */
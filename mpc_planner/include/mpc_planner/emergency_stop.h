@@ -0,0 +1,38 @@
+/*
+ * Emergency-stop fallback plan.
+ *
+ * Maximum braking straight ahead down to standstill, rolled out with the
+ * discretized car model car_dyanmics of C/car_dynamics.c (the RK4 step of
+ * two_abstacles.m for m = I = 1 and a 0.1 s step). The force is the lower
+ * input bound until the car would overshoot standstill within one stage, and
+ * then exactly the force that stops it, so the speed never leaves its bounds.
+ * The obstacles are rolled out at zero input. A plan takes a few
+ * microseconds, cheap enough to keep one ready after every solve.
+ */
+
+#ifndef MPC_PLANNER_EMERGENCY_STOP_H
+#define MPC_PLANNER_EMERGENCY_STOP_H
+
+#include "mpc_planner/problem.h"
+#include "mpc_planner/trajectory.h"
+
+extern "C" {
+/* C/car_dynamics.c: z = [F s x y v theta] to the states [x y v theta] one step later */
+void car_dyanmics(double *x, double *c);
+}
+
+namespace mpc_planner {
+
+static_assert(kStepSize == 0.1 && kMass == 1 && kInertia == 1,
+              "car_dyanmics is discretized for m = I = 1 and a 0.1 s step");
+
+/*
+ * Writes the emergency stop from the states X (ego and obstacles) at time
+ * STAMP to OUT, marked as fallback. Returns whether the ego variables stay
+ * within model.lb/model.ub along the whole plan.
+ */
+bool emergency_stop(const double x[kStates], double stamp, Trajectory* out);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_EMERGENCY_STOP_H */
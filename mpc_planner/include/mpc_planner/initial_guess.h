@@ -0,0 +1,45 @@
+/*
+ * Initial guesses x0 for FORCESNLPsolver (kStages * kStageVars doubles).
+ *
+ * The rollouts start at XINIT and integrate the full model with model_rk4,
+ * obstacles at zero input; ego inputs are kept within the variable bounds.
+ */
+
+#ifndef MPC_PLANNER_INITIAL_GUESS_H
+#define MPC_PLANNER_INITIAL_GUESS_H
+
+#include "mpc_planner/problem.h"
+#include "mpc_planner/trajectory.h"
+
+namespace mpc_planner {
+
+/* radius of the ego lane of two_abstacles.m (the (x^2+y^2-2.25)^2 cost) */
+constexpr double kLaneRadius = 1.5;
+
+constexpr int kGuessSize = kStages * kStageVars;
+
+/* midpoint of the variable bounds at every stage, as in two_abstacles.m */
+void guess_midpoint(double x0[kGuessSize]);
+
+/* PREVIOUS advanced by SHIFT stages, the last stage repeated */
+void guess_shifted(const Trajectory& previous, int shift, double x0[kGuessSize]);
+
+/*
+ * PREVIOUS sampled ELAPSED seconds later at the stage times TIME of the next
+ * solve, for warm starts across time grids: states linear in time, inputs held.
+ */
+void guess_resampled(const Trajectory& previous, double elapsed, const double time[kStages],
+                     double x0[kGuessSize]);
+
+/* full braking down to standstill, straight ahead */
+void guess_braking(const double xinit[kStates], double x0[kGuessSize]);
+
+/* constant speed, steering along the ego lane in the current direction of travel */
+void guess_lane_keep(const double xinit[kStates], double x0[kGuessSize]);
+
+/* force that brakes from speed V as hard as the bounds allow without going below standstill within STEP */
+double braking_force(double v, double mass, double step);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_INITIAL_GUESS_H */
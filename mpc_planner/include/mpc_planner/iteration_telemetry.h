@@ -0,0 +1,144 @@
+/*
+ * Per-iteration telemetry of FORCESNLPsolver: binary records in place of the
+ * printlevel 2 table.
+ *
+ * The solver is observed through its external function. Each iteration
+ * evaluates the model with derivatives in a sweep over all stages, factorizes
+ * the KKT system and then evaluates values only in the sweeps of the line
+ * search. The wrapper timestamps every sweep and splits the solve into
+ *   feval       time inside the model evaluations, all sweeps
+ *   factor      from the end of a derivative sweep to the next sweep
+ *   linesearch  from the end of a value-only sweep to the next sweep
+ * the time from the last sweep to the end of the solve counting likewise.
+ *
+ * Objective and residuals are those of the iterate of the derivative sweep:
+ * res_eq is the largest defect of the dynamics |c_k - E z_k+1|, res_ineq the
+ * largest violation of hl <= h <= hu. Stationarity, barrier parameter and
+ * step lengths are internal to the solver and not observable here.
+ *
+ * With set_counters() the hardware counters of perf_counters.h are read at
+ * the same boundaries and summed per phase; this costs a system call per
+ * boundary, so it is meant for tuning runs rather than always on.
+ *
+ * Records are kept in a ring preallocated in the object, the oldest are
+ * overwritten. The external function takes no user data, so the telemetry
+ * recording on a thread is selected with begin() / end(); Solver does this
+ * around each solve once given a telemetry with set_telemetry().
+ */
+
+#ifndef MPC_PLANNER_ITERATION_TELEMETRY_H
+#define MPC_PLANNER_ITERATION_TELEMETRY_H
+
+#include "mpc_planner/perf_counters.h"
+#include "mpc_planner/problem.h"
+#include "mpc_planner/solver.h"
+
+namespace mpc_planner {
+
+constexpr int kTelemetryCapacity = 4096;
+
+/* seconds per phase, see above */
+struct PhaseTimes {
+    double feval = 0;
+    double factor = 0;
+    double linesearch = 0;
+};
+
+/* hardware counters per phase */
+struct PhaseCounters {
+    CounterValues feval;
+    CounterValues factor;
+    CounterValues linesearch;
+};
+
+/* FORCESNLPsolver_info extended with the phases of the solve, see Solver::extended_info */
+struct ExtendedInfo {
+    FORCESNLPsolver_info info;
+    PhaseTimes time;
+
+    /* zero unless the telemetry reads counters */
+    PhaseCounters counters;
+    bool counted = false;
+};
+
+struct IterationRecord {
+    /* sequence number of the solve, counting from 1 */
+    unsigned long solve = 0;
+    int iteration = 0;
+
+    double objective = 0;
+    double res_eq = 0;
+    double res_ineq = 0;
+
+    /* value-only sweeps after the derivative sweep */
+    int linesearch_steps = 0;
+
+    PhaseTimes time;
+};
+
+class IterationTelemetry {
+public:
+    IterationTelemetry() = default;
+
+    IterationTelemetry(const IterationTelemetry&) = delete;
+    IterationTelemetry& operator=(const IterationTelemetry&) = delete;
+
+    /* reads COUNTERS, opened on the solving thread, at every phase boundary; nullptr to stop */
+    void set_counters(PerfCounters* counters) { counters_ = counters; }
+
+    /* records the evaluations of MODEL made through ext_func on the calling thread, until end() */
+    void begin(FORCESNLPsolver_ExtFunc model);
+    void end();
+
+    /* external function to pass to the solver between begin() and end() */
+    static void ext_func(double* x, double* y, double* l, double* p, double* f, double* nabla_f, double* c,
+                         double* nabla_c, double* h, double* nabla_h, double* H, int stage);
+
+    /* records retained, at(0) the oldest */
+    int size() const;
+    const IterationRecord& at(int i) const;
+
+    /* records overwritten since the last clear() */
+    unsigned long dropped() const { return written_ - size(); }
+
+    /* phase times and iterations of the last solve */
+    const PhaseTimes& totals() const { return totals_; }
+    const PhaseCounters& counter_totals() const { return counted_; }
+    bool counting() const { return counters_ && counters_->is_open(); }
+    int iterations() const { return iterations_; }
+
+    void clear() { written_ = 0; }
+
+private:
+    void evaluate(double* x, double* y, double* l, double* p, double* f, double* nabla_f, double* c,
+                  double* nabla_c, double* h, double* nabla_h, double* H, int stage);
+    void begin_sweep(bool derivatives);
+    void end_sweep();
+    void add_gap(double now);
+    CounterValues count_since_mark();
+    void measure(const double* x, double f, const double* c, const double* h, int stage);
+
+    IterationRecord records_[kTelemetryCapacity];
+    unsigned long written_ = 0;
+    unsigned long solves_ = 0;
+
+    PerfCounters* counters_ = nullptr;
+
+    /* state of the solve in progress */
+    FORCESNLPsolver_ExtFunc model_ = nullptr;
+    IterationRecord* open_ = nullptr;
+    PhaseTimes totals_;
+    PhaseCounters counted_;
+    CounterValues mark_;             /* counters at the last boundary */
+    int iterations_ = 0;
+    bool derivatives_ = false;       /* of the current or last sweep */
+    bool in_sweep_ = false;
+    double sweep_start_ = 0;
+    double sweep_end_ = 0;           /* 0 before the first sweep */
+    double defect_[kStates] = {};    /* dynamics of the previous stage */
+    bool have_defect_ = false;
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_ITERATION_TELEMETRY_H */
@@ -0,0 +1,110 @@
+/*
+ * Concurrent solves of one problem from several initial guesses.
+ *
+ * The generated solver keeps its workspace in static memory, so every worker
+ * loads a private copy of the shared FORCESNLPsolver library (one dlopen per
+ * copy, the same scheme as the context pool of the Python interface) and
+ * solves through FORCESNLPsolver_casadi2forces_deadline. The first worker to
+ * finish OPTIMAL cancels the others, which then stop within one iteration;
+ * without an optimal result the best one is returned. A failed attempt thus
+ * costs the latency of one solve rather than of all retries in a row.
+ */
+
+#ifndef MPC_PLANNER_MULTI_START_H
+#define MPC_PLANNER_MULTI_START_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpc_planner/initial_guess.h"
+#include "mpc_planner/problem.h"
+#include "mpc_planner/solver.h"
+#include "mpc_planner/trajectory.h"
+
+namespace mpc_planner {
+
+/* exitflag of solve() when no attempt could be made */
+constexpr int kMultiStartUnavailable = -1000;
+
+struct MultiStartConfig {
+    /* concurrent solves, i.e. the most guesses per solve() */
+    int workers = 4;
+
+    /* shared FORCESNLPsolver library to load the copies from; empty for the one of the build */
+    std::string library;
+
+    /* per-solve time limit in seconds, 0 for none */
+    double deadline = 0;
+};
+
+class MultiStartSolver {
+public:
+    explicit MultiStartSolver(const MultiStartConfig& config = MultiStartConfig());
+    ~MultiStartSolver();
+
+    MultiStartSolver(const MultiStartSolver&) = delete;
+    MultiStartSolver& operator=(const MultiStartSolver&) = delete;
+
+    /* false if the library copies could not be loaded, see error() */
+    bool ok() const { return ok_; }
+    const std::string& error() const { return error_; }
+
+    int workers() const { return static_cast<int>(workers_.size()); }
+
+    /*
+     * Solves from XINIT once per initial guess in GUESSES (at most workers(),
+     * kGuessSize doubles each) and writes the winning solve to OUT. Returns
+     * its exitflag and, in WINNER, the index of its guess.
+     */
+    int solve(const double xinit[kStates], const double* const* guesses, int count, Trajectory* out,
+              int* winner = nullptr);
+
+    /* inputs and result of the attempt of WORKER in the last solve(), e.g. of its winner */
+    const FORCESNLPsolver_params& params(int worker) const { return workers_[worker]->params; }
+    const FORCESNLPsolver_output& output(int worker) const { return workers_[worker]->output; }
+    const FORCESNLPsolver_info& info(int worker) const { return workers_[worker]->info; }
+
+    /* stage parameters shared by all attempts, [m I] per stage by default */
+    double* all_parameters() { return all_parameters_; }
+
+private:
+    struct Library;
+
+    struct Worker {
+        std::unique_ptr<Library> library;
+        FORCESNLPsolver_params params;
+        FORCESNLPsolver_output output;
+        FORCESNLPsolver_info info;
+        std::FILE* log = nullptr;
+        int exitflag = 0;
+        bool busy = false;
+        bool ran = false;
+        std::thread thread;
+    };
+
+    void run(int index);
+    bool better(const Worker& a, const Worker& b) const;
+
+    MultiStartConfig config_;
+    bool ok_ = false;
+    std::string error_;
+    double all_parameters_[kStages * kStageParams];
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    unsigned long generation_ = 0;
+    int running_ = 0;
+    int first_ = -1;
+    bool decided_ = false;
+    bool quit_ = false;
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_MULTI_START_H */
@@ -0,0 +1,106 @@
+/*
+ * Obstacle states from perception to the solver thread.
+ *
+ * The perception thread keeps a working set of obstacles, updates entries in
+ * place and publishes the whole set at once; the solver thread takes the
+ * latest published set right before each solve. The hand-off is a triple
+ * buffer: no mutex on either side and the solver always sees a set exactly
+ * as it was published, never a mix of two updates.
+ *
+ * Single producer, single consumer.
+ */
+
+#ifndef MPC_PLANNER_OBSTACLE_CHANNEL_H
+#define MPC_PLANNER_OBSTACLE_CHANNEL_H
+
+#include "mpc_planner/problem.h"
+#include "mpc_planner/triple_buffer.h"
+
+namespace mpc_planner {
+
+constexpr int kMaxTrackedObstacles = 64;
+
+struct ObstacleState {
+    /* track id assigned by perception */
+    int id = -1;
+
+    /* x y v theta, as the obstacle states of the model */
+    double x[kCarStates] = {};
+};
+
+struct ObstacleSet {
+    /* steady clock time the states refer to, seconds */
+    double stamp = 0;
+
+    /* false for the default set the consumer sees before the first publish() */
+    bool published = false;
+
+    int count = 0;
+    ObstacleState obstacles[kMaxTrackedObstacles];
+};
+
+class ObstacleChannel {
+public:
+    /* producer: the working set, modify it and then call publish() */
+    ObstacleSet& working() { return working_; }
+
+    /* producer: inserts or updates the obstacle with the given id; false if the set is full */
+    bool update(int id, const double x[kCarStates]);
+
+    /* producer: removes the obstacle with the given id */
+    void remove(int id);
+
+    /* producer: publishes the working set stamped with STAMP */
+    void publish(double stamp);
+
+    /* consumer: latest published set; FRESH tells whether it changed since the last call */
+    const ObstacleSet& snapshot(bool* fresh = nullptr);
+
+private:
+    ObstacleSet working_;
+    TripleBuffer<ObstacleSet> buffer_;
+};
+
+/*
+ * The full model cannot leave an obstacle slot empty: its states are bound to
+ * the slot's lane. A slot without an obstacle is parked at rest at the start
+ * pose of its obstacle in two_abstacles.m, on the lane and clear of the ego.
+ */
+constexpr double kParkedObstacles[kObstacles][kCarStates] = { { -1, 1.11, 0, kPi / 4 }, { -2, 0, 0, kPi / 2 } };
+
+/*
+ * Assignment of tracked obstacles to the kObstacles obstacle slots of the
+ * model. An obstacle keeps its slot for as long as it stays in the set, so
+ * removals from the set never move an obstacle to another slot between
+ * ticks; new obstacles take free slots in the order of the set.
+ */
+class ObstacleSlots {
+public:
+    ObstacleSlots();
+
+    /* assigns the obstacles of SET to slots */
+    void assign(const ObstacleSet& set);
+
+    /* track id of the obstacle in SLOT, -1 if the slot is free */
+    int id(int slot) const { return ids_[slot]; }
+
+    /* index in the last assigned set of the obstacle in SLOT, -1 if the slot is free */
+    int index(int slot) const { return index_[slot]; }
+
+private:
+    int ids_[kObstacles];
+    int index_[kObstacles];
+};
+
+/*
+ * Writes the obstacles of SET into the obstacle states of XINIT (the current
+ * solver models kObstacles obstacles as states), predicted forward from
+ * SET.stamp to STAMP at constant speed and heading. SLOTS keeps the slot of
+ * each obstacle across calls; free slots are set to kParkedObstacles. Until
+ * perception has published a set, XINIT keeps the obstacle states it holds.
+ */
+void write_obstacle_states(const ObstacleSet& set, double stamp, ObstacleSlots* slots, double xinit[kStates]);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_OBSTACLE_CHANNEL_H */
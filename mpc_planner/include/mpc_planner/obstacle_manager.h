@@ -0,0 +1,96 @@
+/*
+ * Any number of obstacles in the fixed obstacle slots of FORCESNLPsolver_ego.
+ *
+ * The solver has kObstacleSlots obstacle constraints per stage. The manager
+ * predicts every tracked obstacle over the horizon and, per stage, puts the
+ * kObstacleSlots obstacles closest to the ego car into the slots; slots left
+ * over are parked far away, so distant agents cost the solver nothing.
+ *
+ * To keep the selection cheap in busy scenes the predicted sweeps are indexed
+ * in a uniform grid: the horizon is cut into windows of a few stages and the
+ * bounding box of each obstacle's sweep over a window is entered into the
+ * grid cells it covers. A stage then only looks at the obstacles found in the
+ * cells around the ego position. The grid is hashed into a fixed number of
+ * buckets, so it has no bounds and needs no allocation; collisions only add
+ * candidates that the exact distance check drops again.
+ */
+
+#ifndef MPC_PLANNER_OBSTACLE_MANAGER_H
+#define MPC_PLANNER_OBSTACLE_MANAGER_H
+
+#include "mpc_planner/ego_problem.h"
+#include "mpc_planner/obstacle_channel.h"
+
+namespace mpc_planner {
+
+struct ObstacleManagerConfig {
+    /* edge length of the grid cells, meters */
+    double cell_size = 1.0;
+
+    /* obstacles farther than this from the ego car at a stage are not constrained, meters */
+    double range = 3.0;
+};
+
+class ObstacleManager {
+public:
+    explicit ObstacleManager(const ObstacleManagerConfig& config = ObstacleManagerConfig());
+
+    /* predicts the obstacles of SET from SET.stamp to STAMP and over the stages STEP apart, and indexes them */
+    void update(const ObstacleSet& set, double stamp, double step = kStepSize);
+
+    /*
+     * Selects the obstacles of every stage around the ego positions EGO_XY
+     * (e.g. the warm start) and writes all_parameters of FORCESNLPsolver_ego.
+     * An obstacle keeps its slot from one stage to the next where possible.
+     */
+    void write_parameters(const double ego_xy[kStages][2], double* all_parameters,
+                          double mass = kMass, double inertia = kInertia);
+
+    /* index in the last ObstacleSet of the obstacle in SLOT at stage K, -1 if the slot is parked */
+    int active(int k, int slot) const { return active_[k][slot]; }
+
+    /* number of obstacle distances evaluated by the last write_parameters() */
+    long candidates() const { return candidates_; }
+
+private:
+    static constexpr int kWindow = 8;   /* stages per sweep */
+    static constexpr int kWindows = (kStages + kWindow - 1) / kWindow;
+    static constexpr int kBuckets = 256;
+    static constexpr int kMaxSweepCells = 16;
+    static constexpr int kMaxEntries = kMaxTrackedObstacles * kMaxSweepCells;
+    static constexpr int kMaxCell = 1 << 24;    /* cell indices are clamped to +-kMaxCell */
+
+    struct CellRange {
+        int x0, y0, x1, y1;
+    };
+
+    int cell(double v) const;
+    static int bucket(int ix, int iy);
+    CellRange sweep(int obstacle, int window) const;
+    void select(int k, const double ego[2]);
+
+    ObstacleManagerConfig config_;
+    int count_ = 0;
+
+    /* predicted x y theta of each obstacle at each stage */
+    double poses_[kMaxTrackedObstacles][kStages][kPoseParams];
+
+    /* per window: obstacles by bucket (bucket b holds entries [start[b], start[b+1])) */
+    int start_[kWindows][kBuckets + 1];
+    int entries_[kWindows][kMaxEntries];
+
+    /* per window: sweeps covering more than kMaxSweepCells cells, candidates everywhere */
+    int wide_count_[kWindows];
+    int wide_[kWindows][kMaxTrackedObstacles];
+
+    /* candidate deduplication within one stage */
+    unsigned visited_[kMaxTrackedObstacles] = {};
+    unsigned query_ = 0;
+
+    int active_[kStages][kObstacleSlots];
+    long candidates_ = 0;
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_OBSTACLE_MANAGER_H */
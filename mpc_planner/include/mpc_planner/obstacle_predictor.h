@@ -0,0 +1,39 @@
+/*
+ * Obstacle prediction outside the optimizer, for FORCESNLPsolver_ego.
+ *
+ * two_abstacles.m optimizes the obstacles together with the ego car. With the
+ * ego-only formulation their motion is rolled forward here instead, with the
+ * RK4 discretization of the car model at zero input (constant speed and
+ * heading), and the predicted poses are written into the stage parameters,
+ * see ego_problem.h.
+ */
+
+#ifndef MPC_PLANNER_OBSTACLE_PREDICTOR_H
+#define MPC_PLANNER_OBSTACLE_PREDICTOR_H
+
+#include "mpc_planner/ego_problem.h"
+#include "mpc_planner/obstacle_channel.h"
+
+namespace mpc_planner {
+
+/* position of slots without an obstacle, far outside the road */
+constexpr double kParkedPosition = 1e3;
+
+/* fills one stage parameter block with [m I] and parked obstacle slots */
+void reset_ego_stage_params(double stage_params[kEgoStageParams], double mass = kMass, double inertia = kInertia);
+
+/* rolls the state X of one obstacle forward over the horizon and writes its poses into slot SLOT of all stages */
+void predict_obstacle(const double x[kCarStates], int slot, double step, double* all_parameters);
+
+/*
+ * Writes the all_parameters of FORCESNLPsolver_ego (kStages * kEgoStageParams
+ * doubles): [m I] and the poses of the first kObstacleSlots obstacles of SET,
+ * predicted from SET.stamp to STAMP and then over the stages STEP apart.
+ * Unused slots are parked at kParkedPosition.
+ */
+void predict_obstacles(const ObstacleSet& set, double stamp, double step, double* all_parameters,
+                       double mass = kMass, double inertia = kInertia);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_OBSTACLE_PREDICTOR_H */
@@ -0,0 +1,65 @@
+/*
+ * Hardware performance counters of the calling thread (Linux perf_event_open).
+ *
+ * The counters are opened as one group, so they are scheduled together and
+ * their ratios stay meaningful; if the kernel multiplexes the group the
+ * values are scaled to the time enabled. Events the CPU or the kernel does
+ * not offer (virtual machines, perf_event_paranoid) are left out of the
+ * group and read as zero; open() fails only if none is available. Reading
+ * costs one system call.
+ *
+ * Other platforms compile, with open() always failing.
+ */
+
+#ifndef MPC_PLANNER_PERF_COUNTERS_H
+#define MPC_PLANNER_PERF_COUNTERS_H
+
+#include <cstdint>
+
+namespace mpc_planner {
+
+enum PerfEvent { kCycles = 0, kInstructions, kLlcMisses, kBranchMisses, kPerfEvents };
+
+struct CounterValues {
+    std::uint64_t value[kPerfEvents] = {};
+
+    CounterValues& operator+=(const CounterValues& other)
+    {
+        for (int i = 0; i < kPerfEvents; i++) value[i] += other.value[i];
+        return *this;
+    }
+};
+
+class PerfCounters {
+public:
+    PerfCounters() = default;
+    ~PerfCounters() { close(); }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /* starts counting on the calling thread, user space only; returns false if no event can be opened */
+    bool open();
+    void close();
+
+    bool is_open() const { return leader_ >= 0; }
+    bool available(PerfEvent event) const { return fd_[event] >= 0; }
+
+    /* counts since open(); zero if not open or the read fails */
+    CounterValues read() const;
+
+    /* name of EVENT for reports */
+    static const char* name(PerfEvent event);
+
+private:
+    int leader_ = -1;
+    int fd_[kPerfEvents] = { -1, -1, -1, -1 };
+
+    /* position of each event in the group read, -1 if not opened */
+    int slot_[kPerfEvents] = { -1, -1, -1, -1 };
+    int opened_ = 0;
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_PERF_COUNTERS_H */
@@ -0,0 +1,161 @@
+/*
+ * Closed-loop planner runtime.
+ *
+ * The closed loop of two_abstacles.m (solve, apply the next stage, solve
+ * again) split over two threads:
+ *
+ *   state estimates --> [solver thread] --> trajectories --> [control thread]
+ *
+ * The solver thread replans at a fixed period from the latest state estimate,
+ * warm-started with the previous solution. The control thread ticks at a
+ * fixed, faster rate and hands the command of the current stage of the latest
+ * trajectory to a callback. Both hand-offs are triple buffers, so the control
+ * tick never waits for the solver and never takes a lock.
+ *
+ * Obstacles can come from a separate perception thread through obstacles();
+ * the solver thread takes the latest published set right before each solve and
+ * it overrides the obstacle states of the state estimate; until the first
+ * set is published those states are used as they are. Optimal plans are
+ * also published to a TrajectoryService for controllers that need references
+ * between the stages.
+ *
+ * After every optimal solve an emergency stop from the next stage is kept
+ * ready; when a solve fails or misses solve_deadline that plan is published
+ * instead, so the vehicle brakes without waiting for another solve.
+ *
+ * With record_path set, every solve is captured by a SolveRecorder for
+ * offline replay (mpc_solve_replay); the solver thread never waits for it.
+ */
+
+#ifndef MPC_PLANNER_PLANNER_RUNTIME_H
+#define MPC_PLANNER_PLANNER_RUNTIME_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "mpc_planner/multi_start.h"
+#include "mpc_planner/obstacle_channel.h"
+#include "mpc_planner/problem.h"
+#include "mpc_planner/solve_recorder.h"
+#include "mpc_planner/solver.h"
+#include "mpc_planner/trajectory.h"
+#include "mpc_planner/trajectory_service.h"
+#include "mpc_planner/triple_buffer.h"
+
+namespace mpc_planner {
+
+struct StateEstimate {
+    /* steady clock, seconds (PlannerRuntime::now()) */
+    double stamp = 0;
+
+    /* ego and obstacle states, the xinit of the solver */
+    double x[kStates] = {};
+};
+
+struct ControlCommand {
+    double stamp = 0;
+
+    /* ego inputs [F s] */
+    double u[kCarInputs] = {};
+
+    /* stage of the trajectory the command was taken from */
+    int stage = 0;
+
+    /* false while neither an optimal trajectory nor an emergency stop is available */
+    bool valid = false;
+};
+
+struct PlannerConfig {
+    /* control tick period, seconds */
+    double control_period = 0.01;
+
+    /* replanning period, seconds; one stage of the horizon by default */
+    double replan_period = kStepSize;
+
+    /* concurrent initial guesses per replan (MultiStartSolver), 0 to solve once with the warm start */
+    int multi_start_workers = 0;
+
+    /* time limit of a solve in seconds, 0 for none; a miss counts as failure */
+    double solve_deadline = 0;
+
+    /* log of all solves (SolveRecorder), empty for none */
+    std::string record_path;
+};
+
+struct PlannerStats {
+    std::atomic<long> solves{0};
+    std::atomic<long> failures{0};
+    std::atomic<long> fallbacks{0};
+    std::atomic<long> solver_overruns{0};
+    std::atomic<long> control_ticks{0};
+    std::atomic<long> control_overruns{0};
+};
+
+class PlannerRuntime {
+public:
+    /* runs on the control thread once per tick; TRAJECTORY is the latest one received */
+    using ControlCallback = std::function<void(const ControlCommand& command, const Trajectory& trajectory)>;
+
+    explicit PlannerRuntime(const PlannerConfig& config = PlannerConfig());
+    ~PlannerRuntime();
+
+    PlannerRuntime(const PlannerRuntime&) = delete;
+    PlannerRuntime& operator=(const PlannerRuntime&) = delete;
+
+    /* must be set before start() */
+    void set_control_callback(ControlCallback callback) { callback_ = std::move(callback); }
+
+    /* starts the solver and control threads; returns false if already running, or the multi-start solver or
+     * the solve log cannot be opened */
+    bool start();
+
+    /* stops and joins both threads */
+    void stop();
+
+    /* estimator side, from a single thread: hands over the latest state estimate */
+    void publish_state(const StateEstimate& state) { states_.write(state); }
+
+    /* perception side, from a single thread: obstacle updates for the solver */
+    ObstacleChannel& obstacles() { return obstacles_; }
+
+    /* reader side, from any thread: interpolated references of the latest optimal plan */
+    const TrajectoryService& trajectory_service() const { return trajectory_service_; }
+
+    /* solver used by the runtime, configure it before start() */
+    Solver& solver() { return solver_; }
+
+    const PlannerStats& stats() const { return stats_; }
+
+    /* the recorder of the solves, nullptr without record_path */
+    const SolveRecorder* recorder() const { return recorder_.get(); }
+
+    /* steady clock in seconds, the time base of all stamps */
+    static double now();
+
+private:
+    void solver_loop();
+    void control_loop();
+
+    PlannerConfig config_;
+    ControlCallback callback_;
+    Solver solver_;
+    std::unique_ptr<MultiStartSolver> multi_start_;
+    std::unique_ptr<SolveRecorder> recorder_;
+
+    TripleBuffer<StateEstimate> states_;
+    TripleBuffer<Trajectory> trajectories_;
+    ObstacleChannel obstacles_;
+    TrajectoryService trajectory_service_;
+
+    PlannerStats stats_;
+    std::atomic<bool> running_{false};
+    std::thread solver_thread_;
+    std::thread control_thread_;
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_PLANNER_RUNTIME_H */
@@ -0,0 +1,82 @@
+/*
+ * Exact collision avoidance between the rectangular footprints of the ego car
+ * and the obstacles, by dual variables of a separating hyperplane (OBCA).
+ *
+ * The ellipses of two_obstacles_ego.m over-approximate long vehicles. Two
+ * convex polygons, the ego footprint {R(theta) y + p : G y <= g} and an
+ * obstacle {y : A y <= b}, are at least d_min apart iff there are
+ * lambda, mu >= 0 with
+ *   (A p - b)' lambda - g' mu >= d_min,  G' mu + R' A' lambda = 0,  |A' lambda| <= 1
+ * For boxes G = [I; -I], so mu = [mu+; mu-] and the equality eliminates
+ * mu- = mu+ + R' A' lambda, which leaves inequalities only: per obstacle the
+ * stage carries lambda (4) and mu+ (2), and h the rows
+ *   separation >= d_min,  |A' lambda|^2 <= 1,  mu+ + R' A' lambda >= 0 (2 rows)
+ * The duals are local to their stage and enter neither the dynamics nor the
+ * cost, so they add to the stage blocks of the structured solver without
+ * coupling the stages.
+ *
+ * Layout of FORCESNLPsolver_obca (two_obstacles_obca.m), with the parameters
+ * of ego_problem.h:
+ *   z = [F s x y v theta | lambda_1 mu_1 | lambda_2 mu_2]
+ * lambda is ordered as the faces of A: +heading, +left, -heading, -left.
+ */
+
+#ifndef MPC_PLANNER_POLYGON_AVOIDANCE_H
+#define MPC_PLANNER_POLYGON_AVOIDANCE_H
+
+#include "mpc_planner/ego_problem.h"
+
+namespace mpc_planner {
+
+/* half extents of a footprint along and across its heading, m */
+struct Footprint {
+    double half_length;
+    double half_width;
+};
+
+constexpr Footprint kEgoFootprint = { 0.25, 0.12 };
+constexpr Footprint kObstacleFootprint = { 0.25, 0.12 };
+constexpr double kMinSeparation = 0.05;  /* d_min, m */
+
+constexpr int kObcaLambdas = 4;
+constexpr int kObcaMus = 2;
+constexpr int kObcaSlotVars = kObcaLambdas + kObcaMus;
+constexpr int kObcaRows = 4;
+constexpr int kObcaStageVars = kEgoStageVars + kObstacleSlots * kObcaSlotVars;  /* model.nvar */
+constexpr int kObcaIneqs = kObstacleSlots * kObcaRows;                         /* model.nh */
+
+/* rows of one obstacle within h, and their model.hl / model.hu */
+enum ObcaRow { kObcaSeparation = 0, kObcaDualNorm, kObcaBalanceX, kObcaBalanceY };
+constexpr double kObcaLower[kObcaRows] = { kMinSeparation, -kInf, 0, 0 };
+constexpr double kObcaUpper[kObcaRows] = { kInf, 1, kInf, kInf };
+
+/* first dual variable of obstacle SLOT within the stage variables */
+constexpr int obca_duals(int slot)
+{
+    return kEgoStageVars + kObcaSlotVars * slot;
+}
+
+/*
+ * Dual variables that certify the separation of the footprints at the poses
+ * EGO and OBSTACLE ([x y theta]) along the best of their four face normals,
+ * and that separation. Negative if the footprints overlap. The duals are
+ * feasible for the constraints above whenever the separation is >= d_min,
+ * which makes them a warm start for the solver.
+ */
+double separating_duals(const double ego[kPoseParams], const Footprint& ego_footprint,
+                        const double obstacle[kPoseParams], const Footprint& obstacle_footprint,
+                        double lambda[kObcaLambdas], double mu[kObcaMus]);
+
+/*
+ * The kObcaIneqs rows of h of one stage and, unless nullptr, their entries of
+ * the column-major kObcaIneqs x kObcaStageVars NABLA_H, in the layout of the
+ * external function. P holds the obstacle poses as in ego_problem.h.
+ */
+void obca_constraints(const double z[kObcaStageVars], const double* p, double h[kObcaIneqs], double* nabla_h);
+
+/* fills the duals of every stage of the initial guess X0 (kStages stages) from the poses in ALL_PARAMETERS */
+void warm_start_duals(double* x0, const double* all_parameters);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_POLYGON_AVOIDANCE_H */
@@ -0,0 +1,52 @@
+/*
+ * Problem layout of FORCESNLPsolver, as generated by two_abstacles.m.
+ *
+ * Each of the kStages stages holds the variables
+ *   z = [F s | F1 s1 | F2 s2 | x y v theta | x1 y1 v1 theta1 | x2 y2 v2 theta2]
+ * i.e. the inputs and states of the ego car followed by those of the two
+ * obstacles. xinit holds the 12 states, all_parameters [m I] per stage.
+ */
+
+#ifndef MPC_PLANNER_PROBLEM_H
+#define MPC_PLANNER_PROBLEM_H
+
+#include <limits>
+
+namespace mpc_planner {
+
+constexpr int kStages = 85;        /* model.N */
+constexpr int kStageVars = 18;     /* model.nvar */
+constexpr int kInputs = 6;         /* inputs per stage, ego first */
+constexpr int kStates = 12;        /* model.neq, states per stage, ego first */
+constexpr int kStageParams = 2;    /* model.npar: [m I] */
+constexpr int kIneqs = 5;          /* model.nh */
+constexpr int kObstacles = 2;      /* obstacles modeled as extra states */
+constexpr int kCarStates = 4;      /* x y v theta */
+constexpr int kCarInputs = 2;      /* F s */
+constexpr double kStepSize = 0.1;  /* integrator_stepsize */
+
+/* ego states within the state vector; obstacle i starts at kCarStates*(i+1) */
+enum StateIndex { kX = 0, kY = 1, kV = 2, kTheta = 3 };
+
+/* ego inputs within the input vector */
+enum InputIndex { kForce = 0, kSteer = 1 };
+
+/* model.lb / model.ub */
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kLowerBounds[kStageVars] = { -5, -1, -0.01, -1, -0.01, -1,
+                                              -3, -1, 0, -kPi, -3, 0, 0, -kPi, -3, 0, 0, -kPi };
+constexpr double kUpperBounds[kStageVars] = { +5, +1, +0.01, +1, +0.01, +1,
+                                              3, 3, 1, +kPi, 3, 3, 1, +kPi, 3, 3, 1, +kPi };
+
+/* model.hl / model.hu: road annulus, lanes of the obstacles, obstacle ellipses */
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr double kIneqLower[kIneqs] = { 2, -0.1, -0.1, 1, 1 };
+constexpr double kIneqUpper[kIneqs] = { 9, 0.1, 0.1, kInf, kInf };
+
+/* physical constants of the model */
+constexpr double kMass = 1;
+constexpr double kInertia = 1;
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_PROBLEM_H */
@@ -0,0 +1,146 @@
+/*
+ * Curvilinear road geometry along a reference path.
+ *
+ * two_abstacles.m hard-codes the road as an annulus around the origin. A
+ * ReferencePath describes it by its centerline instead: a C2 cubic spline
+ * through waypoints, resampled at a uniform arc-length spacing so that the
+ * point at any s is found by indexing. A grid over the band of width margin
+ * around the path stores the nearest sample of each cell, which makes the
+ * projection of a position (x, y) to the Frenet coordinates (s, d) constant
+ * time: a lookup followed by a fixed number of Newton steps. d is positive to
+ * the left. The grid keeps only the tiles of cells the band touches, in a
+ * hash table, so its size follows the length of the road and not the area
+ * of its bounding box.
+ *
+ * FORCESNLPsolver_road (two_abstacles_road.m) takes the road from its stage
+ * parameters, p = [m I | x y theta kappa left right]: a point of the
+ * centerline near the stage, its heading and curvature and the lane
+ * boundaries. road_frenet evaluates the second order expansion of (s, d)
+ * around that point that the solver uses, so the geometry can change at
+ * runtime without regenerating the solver.
+ */
+
+#ifndef MPC_PLANNER_REFERENCE_PATH_H
+#define MPC_PLANNER_REFERENCE_PATH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "mpc_planner/problem.h"
+
+namespace mpc_planner {
+
+/* stage parameters of FORCESNLPsolver_road */
+enum RoadParam { kRoadX = 0, kRoadY, kRoadTheta, kRoadKappa, kRoadLeft, kRoadRight, kRoadParams };
+constexpr int kParamRoad = kStageParams;                       /* first road parameter */
+constexpr int kRoadStageParams = kStageParams + kRoadParams;   /* model.npar */
+
+struct ReferencePathConfig {
+    /* arc length between the samples of the centerline, m */
+    double sample_spacing = 0.05;
+
+    /* the projection grid: cell size and how far it reaches from the centerline, m */
+    double cell_size = 0.05;
+    double margin = 2;
+
+    /* cells of the grid at most, counted in whole tiles: 128 MB, twice that while building */
+    long max_grid_cells = 1L << 25;
+
+    /* lane boundaries, distance of the left and right edge from the centerline, m */
+    double left_width = 1;
+    double right_width = 1;
+
+    /* whether the last waypoint connects back to the first */
+    bool closed = false;
+};
+
+/* a point of the centerline */
+struct PathPoint {
+    double s;
+    double x, y;
+    double theta;   /* heading */
+    double kappa;   /* curvature, positive turning left */
+};
+
+/* Frenet coordinates of a position and their gradients w.r.t. (x, y) */
+struct FrenetPoint {
+    double s, d;
+    double ds[2], dd[2];
+};
+
+class ReferencePath {
+public:
+    /*
+     * Builds the path through the N waypoints (X[i], Y[i]), at least 2 and 3
+     * if closed, without repeating the first one at the end. Returns false if
+     * they are too few or coincide, or if the grid would exceed
+     * max_grid_cells. Allocates; the queries below do not.
+     */
+    bool build(const ReferencePathConfig& config, const double* x, const double* y, int n);
+
+    bool empty() const { return samples_.empty(); }
+    bool closed() const { return config_.closed; }
+    double length() const { return length_; }
+    const ReferencePathConfig& config() const { return config_; }
+
+    /* the point at arc length S, wrapped on closed paths and clamped on open ones */
+    PathPoint point(double s) const;
+
+    /*
+     * Projects (X, Y) onto the centerline. Past the ends of an open path, s
+     * continues along the end tangents. Returns false if the position is
+     * outside the grid; F then comes from a search over all samples.
+     */
+    bool project(double x, double y, FrenetPoint* f) const;
+
+private:
+    struct Sample {
+        double x, y;
+        double tx, ty;  /* unit tangent */
+        double kappa;
+    };
+
+    /* segment of S and the position within it, in [0, 1) */
+    int locate(double s, double* tau) const;
+    void evaluate(double s, double c[2], double dc[2], double ddc[2]) const;
+    int nearest_sample(double x, double y) const;
+    double wrap(double s) const;
+
+    ReferencePathConfig config_;
+    double length_ = 0;
+    double spacing_ = 0;
+    int segments_ = 0;
+    std::vector<Sample> samples_;
+
+    /* tiles of the grid by tile index, open addressing; first is the offset of its cells in grid_ */
+    struct Tile {
+        std::int64_t key;
+        std::int32_t first;
+    };
+    const Tile& tile(std::int64_t key) const;
+
+    double grid_x_ = 0, grid_y_ = 0;
+    int grid_nx_ = 0, grid_ny_ = 0;
+    int tiles_nx_ = 0;
+    std::vector<Tile> tiles_;
+    std::vector<std::int32_t> grid_;
+};
+
+/*
+ * (s, d) relative to the road point of the stage parameters P, to second
+ * order in the offset from it, and their gradients, as in
+ * two_abstacles_road.m. Any output may be nullptr.
+ */
+void road_frenet(const double* p, double x, double y, double* s, double* d, double ds[2], double dd[2]);
+
+/*
+ * Writes the all_parameters of FORCESNLPsolver_road (kStages *
+ * kRoadStageParams doubles): [m I] and the point of PATH at arc length S[k]
+ * for each stage, e.g. the projections of the previous solution.
+ */
+void write_road_params(const ReferencePath& path, const double s[kStages], double* all_parameters,
+                       double mass = kMass, double inertia = kInertia);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_REFERENCE_PATH_H */
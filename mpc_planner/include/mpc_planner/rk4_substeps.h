@@ -0,0 +1,47 @@
+/*
+ * Explicit RK4 with several substeps per shooting stage.
+ *
+ * A stage of length h is integrated with M RK4 steps of h/M; the
+ * intermediate states never become solver variables, so the NLP keeps one
+ * set of stage variables per stage. With the error of RK4 falling as
+ * (h/M)^4, e.g. 30 stages of 0.3 s with M = 3 match the fidelity of 85
+ * stages of 0.1 s at about a third of the variables and constraints.
+ *
+ * The sensitivities are propagated alongside the states in forward mode:
+ * each RK4 stage k = f(x, u) carries its tangent dk = A(x) dx + B du, so
+ * the result is the exact derivative of the discrete map of all substeps.
+ * The MATLAB counterpart is two_abstacles_substeps.m.
+ */
+
+#ifndef MPC_PLANNER_RK4_SUBSTEPS_H
+#define MPC_PLANNER_RK4_SUBSTEPS_H
+
+#include "mpc_planner/ego_problem.h"
+#include "mpc_planner/problem.h"
+
+namespace mpc_planner {
+
+/*
+ * SUBSTEPS RK4 steps of H / SUBSTEPS for one car from X with inputs U held.
+ * Writes x+ to X_NEXT and, unless nullptr, its sensitivities DX (d x+/dx)
+ * and DU (d x+/du).
+ */
+void car_rk4_substeps(const double x[kCarStates], const double u[kCarInputs], double m, double I, double h,
+                      int substeps, double x_next[kCarStates], double dx[kCarStates][kCarStates] = nullptr,
+                      double du[kCarStates][kCarInputs] = nullptr);
+
+/*
+ * Dynamics of an ego stage in the layout of the external function, as
+ * ego_collocation in collocation.h: Z = [F s x y v theta], P = [m I ...],
+ * C = x+ and NABLA_C its 4 x 6 Jacobian w.r.t. z, column major.
+ */
+void ego_rk4_substeps(const double z[kEgoStageVars], const double* p, double h, int substeps,
+                      double c[kCarStates], double nabla_c[kCarStates * kEgoStageVars]);
+
+/* the full model (ego and obstacles), P = [m I]; model_rk4 for SUBSTEPS = 1 */
+void model_rk4_substeps(const double x[kStates], const double u[kInputs], const double p[kStageParams], double h,
+                        int substeps, double x_next[kStates]);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_RK4_SUBSTEPS_H */
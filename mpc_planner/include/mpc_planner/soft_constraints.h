@@ -0,0 +1,60 @@
+/*
+ * Soft inequality constraints by exact penalty, with the slacks eliminated.
+ *
+ * A hard row hl <= h(z) <= hu that cannot be met leaves the solver without a
+ * feasible point: it runs to maxit or stops with NOPROGRESS. Softened, the
+ * row becomes hl - s <= h(z) <= hu + s with s >= 0 and the objective is
+ * charged l1 s + l2 s^2 / 2. For given z the optimal slack is the violation
+ *   v = max(hl - h(z), h(z) - hu, 0)
+ * so s is eliminated in closed form and the row turns into the penalty
+ *   l1 v + l2 v^2 / 2
+ * of the objective: no slack variables and no inequality row, i.e. a
+ * smaller KKT system than the hard row, and always a feasible problem.
+ * With l1 above the multiplier the hard row would have, the penalty is
+ * exact: any feasible solution is kept, otherwise the least violating one is
+ * returned.
+ *
+ * To stay differentiable the kink of the L1 term at v = 0 is replaced by a
+ * parabola of width e = `smoothing` on the feasible side of the bound,
+ * l1 huber(v + e) with huber(u) = u^2 / (2 e) up to e, u - e / 2 beyond. Any
+ * violation v >= 0 is charged l1 (v + e / 2), so its slope is the full l1
+ * and exactness is kept; the price is a row that binds up to e inside its
+ * bound and the constant l1 e / 2 in f. For rows with both bounds v is taken
+ * w.r.t. the nearer one.
+ *
+ * The rows are evaluated as h and nabla_h of the external function; soften
+ * adds the penalties to f, nabla_f and, with the Gauss-Newton term of the
+ * violation, H. two_obstacles_soft.m states the same penalty in MATLAB.
+ */
+
+#ifndef MPC_PLANNER_SOFT_CONSTRAINTS_H
+#define MPC_PLANNER_SOFT_CONSTRAINTS_H
+
+namespace mpc_planner {
+
+/* a softened row of h with its L1 and L2 weights */
+struct SoftRow {
+    int row;
+    double l1;
+    double l2;
+};
+
+constexpr double kSoftSmoothing = 1e-3;
+
+/* penalty of the signed violation V (negative inside the bound), with its first and second derivative unless nullptr */
+double soft_penalty(double v, double l1, double l2, double smoothing, double* d1 = nullptr, double* d2 = nullptr);
+
+/*
+ * Adds the penalties of the COUNT rows ROWS to *F, NABLA_F (NVAR) and H
+ * (NVAR x NVAR, column major), given the NH rows H, their column-major
+ * Jacobian NABLA_H and the bounds HL, HU. Any output may be nullptr.
+ */
+void soften(const SoftRow* rows, int count, int nh, int nvar, const double* h, const double* nabla_h,
+            const double* hl, const double* hu, double smoothing, double* f, double* nabla_f, double* H);
+
+/* the largest violation among ROWS, 0 if all hold */
+double soft_violation(const SoftRow* rows, int count, const double* h, const double* hl, const double* hu);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_SOFT_CONSTRAINTS_H */
@@ -0,0 +1,169 @@
+/*
+ * Always-on recorder of the solves of the planner runtime.
+ *
+ * Every solve is captured with its complete input (FORCESNLPsolver_params)
+ * and result (output, exitflag, info), so that a slow or failed solve from
+ * the field can be reproduced with mpc_solve_replay.
+ *
+ * The solver thread copies each record into a ring of slots preallocated at
+ * construction and never waits: when the ring is full the record is dropped
+ * and counted. A writer thread drains the ring into an append-only log.
+ * Consecutive solves differ little (warm start, slowly moving xinit), so each
+ * record is encoded as the XOR of its 64-bit words with those of the
+ * previous record: equal words become runs of zeros, and close doubles leave
+ * only their low bytes. Every keyframe_interval records a keyframe is encoded
+ * against zeros. Each frame starts with a sync word and carries a CRC-32, so
+ * a corrupt frame, header or payload, is detected and the reader scans
+ * forward to the next sync word: it loses only the records up to the next
+ * keyframe. A log cut off by a crash ends at its last whole frame.
+ *
+ * Log format, native byte order:
+ *   header  "FNLPSLOG", uint32 version, uint32 sizeof(SolveRecord)
+ *   frame   uint32 sync "FRME", uint32 payload bytes, uint32 kind (0 keyframe,
+ *           1 delta), uint32 CRC-32 of payload bytes, kind and payload, payload
+ *   payload per run: varint zero words, varint literal words, and for each
+ *           literal one byte with its count of significant bytes n (1..8)
+ *           followed by its n low bytes
+ */
+
+#ifndef MPC_PLANNER_SOLVE_RECORDER_H
+#define MPC_PLANNER_SOLVE_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpc_planner/solver.h"
+
+namespace mpc_planner {
+
+struct SolveRecord {
+    /* stamp of the state estimate the solve started from */
+    double stamp;
+
+    /* time limit of the solve in seconds, 0 for none; an expired solve is not reproducible */
+    double deadline;
+
+    std::int32_t exitflag;
+
+    /* initial guess that won a multi-start solve, -1 for a single solve */
+    std::int32_t guess;
+
+    FORCESNLPsolver_params params;
+    FORCESNLPsolver_output output;
+    FORCESNLPsolver_info info;
+};
+
+constexpr int kRecordWords = static_cast<int>((sizeof(SolveRecord) + 7) / 8);
+
+struct SolveRecorderConfig {
+    /* log file, appended to */
+    std::string path;
+
+    /* records the ring holds before the solver thread has to drop */
+    int slots = 32;
+
+    /* records between keyframes */
+    int keyframe_interval = 100;
+
+    /* writer poll period when the ring is empty, seconds */
+    double flush_period = 0.05;
+};
+
+class SolveRecorder {
+public:
+    explicit SolveRecorder(const SolveRecorderConfig& config);
+
+    /* writes out the records still in the ring */
+    ~SolveRecorder();
+
+    SolveRecorder(const SolveRecorder&) = delete;
+    SolveRecorder& operator=(const SolveRecorder&) = delete;
+
+    /* false if the log could not be opened, see error() */
+    bool ok() const { return ok_; }
+    const std::string& error() const { return error_; }
+
+    /* solver thread: copies a solve into the ring; false if it is full and the record is dropped */
+    bool record(double stamp, double deadline, int guess, const FORCESNLPsolver_params& params,
+                const FORCESNLPsolver_output& output, int exitflag, const FORCESNLPsolver_info& info);
+
+    unsigned long recorded() const { return head_.load(std::memory_order_relaxed); }
+    unsigned long dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    unsigned long bytes_written() const { return bytes_.load(std::memory_order_relaxed); }
+
+    /* true after a write to the log failed; later records are discarded */
+    bool failed() const { return failed_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::uint64_t words[kRecordWords];
+    };
+
+    void writer_loop();
+    void write_record(const Slot& slot);
+
+    SolveRecorderConfig config_;
+    bool ok_ = false;
+    std::string error_;
+    std::FILE* file_ = nullptr;
+
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<unsigned long> head_{0};   /* records published by the solver thread */
+    std::atomic<unsigned long> tail_{0};   /* records taken by the writer */
+    std::atomic<unsigned long> dropped_{0};
+    std::atomic<unsigned long> bytes_{0};
+    std::atomic<bool> failed_{false};
+
+    /* writer state */
+    std::unique_ptr<Slot> previous_;
+    std::vector<unsigned char> buffer_;
+    unsigned long written_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool quit_ = false;
+    std::thread writer_;
+};
+
+/* sequential decoder of a log written by SolveRecorder */
+class SolveLogReader {
+public:
+    SolveLogReader() = default;
+    ~SolveLogReader();
+
+    SolveLogReader(const SolveLogReader&) = delete;
+    SolveLogReader& operator=(const SolveLogReader&) = delete;
+
+    /* false if PATH cannot be read or is not a log of this SolveRecord layout, see error() */
+    bool open(const std::string& path);
+
+    /* decodes the next record; false at the end of the log */
+    bool next(SolveRecord* record);
+
+    const std::string& error() const { return error_; }
+
+    /* frames that could not be decoded, or followed one that could not */
+    unsigned long skipped() const { return skipped_; }
+
+private:
+    /* counts a lost frame and seeks to the next sync word from OFFSET; false at the end of the log */
+    bool resync(long offset);
+
+    std::FILE* file_ = nullptr;
+    std::unique_ptr<std::uint64_t[]> words_;
+    std::vector<unsigned char> buffer_;
+    bool have_key_ = false;
+    unsigned long skipped_ = 0;
+    std::string error_;
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_SOLVE_RECORDER_H */
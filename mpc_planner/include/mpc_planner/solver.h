@@ -0,0 +1,86 @@
+/*
+ * C++ front end of the generated FORCESNLPsolver.
+ *
+ * The generated solver keeps its workspace in static memory: only one Solver
+ * may solve at a time per loaded solver library.
+ */
+
+#ifndef MPC_PLANNER_SOLVER_H
+#define MPC_PLANNER_SOLVER_H
+
+#include <cstdio>
+
+/* FORCESNLPsolver.h guards its extern "C" block with _cplusplus */
+extern "C" {
+#include "FORCESNLPsolver.h"
+
+void FORCESNLPsolver_casadi2forces(double *x, double *y, double *l, double *p, double *f, double *nabla_f,
+                                   double *c, double *nabla_c, double *h, double *nabla_h, double *H, int stage);
+
+/* FORCESNLPsolver_deadline.c */
+void FORCESNLPsolver_casadi2forces_deadline(double *x, double *y, double *l, double *p, double *f, double *nabla_f,
+                                            double *c, double *nabla_c, double *h, double *nabla_h, double *H,
+                                            int stage);
+void FORCESNLPsolver_set_deadline(double seconds);
+void FORCESNLPsolver_cancel(void);
+}
+
+#include "mpc_planner/problem.h"
+#include "mpc_planner/trajectory.h"
+
+namespace mpc_planner {
+
+class IterationTelemetry;
+struct ExtendedInfo;
+
+static_assert(sizeof(FORCESNLPsolver_output) == sizeof(double) * kStages * kStageVars,
+              "FORCESNLPsolver does not match problem.h");
+static_assert(sizeof(FORCESNLPsolver_params) == sizeof(double) * (kStates + kStages * (kStageVars + kStageParams)),
+              "FORCESNLPsolver does not match problem.h");
+
+class Solver {
+public:
+    /* LOG receives the solver's progress output; nullptr discards it */
+    explicit Solver(std::FILE* log = nullptr);
+    ~Solver();
+
+    Solver(const Solver&) = delete;
+    Solver& operator=(const Solver&) = delete;
+
+    /* resets the initial guess to the midpoint of the variable bounds and the parameters to [m I] */
+    void reset();
+
+    /* shifts the last solution SHIFT stages forward in time and uses it as initial guess */
+    void warm_start(int shift);
+
+    /* solves from XINIT and writes the result to OUT; returns the exitflag */
+    int solve(const double xinit[kStates], Trajectory* out);
+
+    /* external function evaluation passed to the solver (the CasADi adapter by default) */
+    void set_ext_func(FORCESNLPsolver_ExtFunc ext_func) { ext_func_ = ext_func; }
+
+    /* records the iterations of every solve into TELEMETRY (iteration_telemetry.h); nullptr to stop */
+    void set_telemetry(IterationTelemetry* telemetry) { telemetry_ = telemetry; }
+
+    FORCESNLPsolver_params& params() { return params_; }
+    const FORCESNLPsolver_output& output() const { return output_; }
+    const FORCESNLPsolver_info& info() const { return info_; }
+    const IterationTelemetry* telemetry() const { return telemetry_; }
+
+    /* info() of the last solve with the phase times and counters of the telemetry, if any */
+    void extended_info(ExtendedInfo* out) const;
+
+private:
+    FORCESNLPsolver_params params_;
+    FORCESNLPsolver_output output_;
+    FORCESNLPsolver_info info_;
+    FORCESNLPsolver_ExtFunc ext_func_;
+    IterationTelemetry* telemetry_;
+    std::FILE* log_;
+    bool own_log_;
+    bool solved_;
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_SOLVER_H */
@@ -0,0 +1,93 @@
+/*
+ * LQR terminal cost and terminal set of the ego car.
+ *
+ * The fixed pull 100*(x-1.5)^2 + 100*y^2 of model.objectiveN only
+ * stabilizes with a long horizon. Instead, the terminal stage is charged
+ * the cost-to-go of the LQR controller of the car linearized around the
+ * reference,
+ *   V(e) = 1/2 e' P e,  e = x - x_ref
+ * with P the stabilizing solution of the discrete algebraic Riccati
+ * equation of the RK4 discretization (A, B from car_rk4_substeps), and
+ * constrained to the level set e' P e <= alpha in which the LQR law
+ * u = u_ref - K e satisfies the bounds of ego_problem.h. The reference is a
+ * pose moving at constant speed and heading (u_ref = 0 keeps the Jacobians
+ * constant along it); at standstill the position is not stabilizable and
+ * terminal_ingredients fails.
+ *
+ * FORCESNLPsolver_terminal (two_obstacles_terminal.m) takes P as its
+ * Cholesky factor L and alpha from the stage parameters, appended to those
+ * of tracking_cost.h; the reference is the z_ref there.
+ */
+
+#ifndef MPC_PLANNER_TERMINAL_COST_H
+#define MPC_PLANNER_TERMINAL_COST_H
+
+#include "mpc_planner/tracking_cost.h"
+
+namespace mpc_planner {
+
+/* terminal parameters of a stage, after the kTrackingStageParams of tracking_cost.h */
+constexpr int kTerminalFactor = 0;                                    /* lower triangle of L, by columns */
+constexpr int kTerminalAlpha = kCarStates * (kCarStates + 1) / 2;
+constexpr int kTerminalParams = kTerminalAlpha + 1;
+constexpr int kParamTerminal = kTrackingStageParams;
+constexpr int kTerminalStageParams = kTrackingStageParams + kTerminalParams;  /* model.npar */
+constexpr int kTerminalStages = 30;                                   /* model.N */
+
+struct TerminalConfig {
+    /* stage weights of the LQR problem, diagonal */
+    double state_weight[kCarStates] = { 1, 1, 0.1, 0.1 };
+    double input_weight[kCarInputs] = { 0.2, 0.02 };
+
+    double step = kStepSize;
+    int substeps = 1;
+
+    /* Riccati iteration stops once P changes by less than this, relative */
+    double tolerance = 1e-10;
+    int max_iterations = 10000;
+
+    /* shrinks the terminal set for the error of the linearization */
+    double set_scale = 0.5;
+};
+
+struct TerminalCost {
+    double x_ref[kCarStates];
+    double u_ref[kCarInputs];
+    double P[kCarStates][kCarStates];
+    double K[kCarInputs][kCarStates];
+    double alpha;
+    int iterations;
+};
+
+/*
+ * Solves the Riccati equation for the car linearized at X_REF, U_REF (P =
+ * [m I]) and derives K and alpha. Returns false if the iteration does not
+ * converge, e.g. at standstill; TERMINAL is then left incomplete.
+ */
+bool terminal_ingredients(const TerminalConfig& config, const double x_ref[kCarStates],
+                          const double u_ref[kCarInputs], const double p[kStageParams], TerminalCost* terminal);
+
+/*
+ * V of an ego stage in the layout of the external function: adds V to *F and
+ * its gradient and Hessian to NABLA_F and H (column major), so it combines
+ * with tracking_cost. Any output may be nullptr.
+ */
+void terminal_cost(const TerminalCost& terminal, const double z[kEgoStageVars], double* f, double* nabla_f,
+                   double* H);
+
+/* the terminal set as row ROW of NH inequalities, h = e' P e - alpha <= 0, with its entries of NABLA_H */
+void terminal_set(const TerminalCost& terminal, const double z[kEgoStageVars], int row, int nh, double* h,
+                  double* nabla_h);
+
+/*
+ * Writes TERMINAL into the terminal parameters of the last of STAGES stages
+ * of ALL_PARAMETERS (STAGES x kTerminalStageParams, kTerminalStages for
+ * FORCESNLPsolver_terminal), with x_ref as reference states and no tracking
+ * weight on them, and makes the terminal rows of the other stages inactive
+ * (L = 0, alpha = 1).
+ */
+void set_terminal_params(double* all_parameters, int stages, const TerminalCost& terminal);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_TERMINAL_COST_H */
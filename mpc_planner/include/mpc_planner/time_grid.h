@@ -0,0 +1,52 @@
+/*
+ * Non-uniform stage spacing for FORCESNLPsolver_timegrid, as generated by
+ * two_abstacles_timegrid.m.
+ *
+ * That solver takes the RK4 step of every stage from its parameters,
+ * p = [m I dt], and weighs the stage cost with dt, so the grid can be fine
+ * near the vehicle and coarse towards the end of the horizon. The horizon
+ * length in stages can change at runtime within the kStages the solver was
+ * generated with: stages past the active ones get dt = 0, their states repeat
+ * the last active one and they cost nothing.
+ */
+
+#ifndef MPC_PLANNER_TIME_GRID_H
+#define MPC_PLANNER_TIME_GRID_H
+
+#include "mpc_planner/problem.h"
+
+namespace mpc_planner {
+
+constexpr int kGridStageParams = kStageParams + 1;  /* model.npar: [m I dt] */
+constexpr int kParamStep = kStageParams;
+
+struct TimeGridConfig {
+    /* stages in use, at most kStages */
+    int stages = kStages;
+
+    /* spacing of the first stages, seconds */
+    double first_step = 0.05;
+
+    /* time of the last stage, seconds; the lookahead of the uniform grid by default */
+    double horizon = kStepSize * (kStages - 1);
+};
+
+/*
+ * Writes the step from each stage to the next into STEP: growing
+ * geometrically from first_step so that the active stages span horizon
+ * (uniform if first_step is already too coarse), 0 past the active stages.
+ * Returns the number of active stages, 0 with all steps 0 unless first_step
+ * and horizon are positive and finite.
+ */
+int make_time_grid(const TimeGridConfig& config, double step[kStages]);
+
+/* stage times from the steps, starting at 0 */
+void grid_times(const double step[kStages], double time[kStages]);
+
+/* writes [m I dt] of every stage into the all_parameters of FORCESNLPsolver_timegrid */
+void write_time_grid(const double step[kStages], double* all_parameters, double mass = kMass,
+                     double inertia = kInertia);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_TIME_GRID_H */
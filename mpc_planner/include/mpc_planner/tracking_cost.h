@@ -0,0 +1,64 @@
+/*
+ * Reference tracking cost of the ego stages, driven by the parameters.
+ *
+ * two_obstacles_ego.m compiles the lane radius and the terminal target into
+ * the solver. FORCESNLPsolver_track (two_obstacles_tracking.m) reads them
+ * from the stage parameters instead, appended to those of ego_problem.h:
+ *   p = [m I poses... | z_ref (6) | q (6) | r_lane w_lane]
+ * and minimizes per stage the least squares
+ *   f = 1/2 sum_i q_i (z_i - z_ref_i)^2 + 1/2 w_lane (x^2 + y^2 - r_lane^2)^2
+ * so the planner retargets every tick, including the terminal stage, by
+ * writing all_parameters.
+ *
+ * With the residuals r = [sqrt(q) (z - z_ref); sqrt(w_lane) (x^2 + y^2 -
+ * r_lane^2)] the gradient is J' r and the Gauss-Newton Hessian J' J, both in
+ * closed form: diag(q) plus the rank-one 4 w_lane [x y]' [x y]. It is positive
+ * semidefinite by construction, which spares the solver the regularization
+ * of the indefinite exact Hessian of the lane term.
+ */
+
+#ifndef MPC_PLANNER_TRACKING_COST_H
+#define MPC_PLANNER_TRACKING_COST_H
+
+#include "mpc_planner/ego_problem.h"
+
+namespace mpc_planner {
+
+/* tracking parameters of a stage, after the kEgoStageParams of ego_problem.h */
+enum TrackingParam {
+    kTrackReference = 0,
+    kTrackWeight = kTrackReference + kEgoStageVars,
+    kTrackLaneRadius = kTrackWeight + kEgoStageVars,
+    kTrackLaneWeight,
+    kTrackingParams
+};
+constexpr int kParamTracking = kEgoStageParams;
+constexpr int kTrackingStageParams = kEgoStageParams + kTrackingParams;  /* model.npar */
+
+struct TrackingReference {
+    double z[kEgoStageVars];
+    double weight[kEgoStageVars];
+    double lane_radius;
+    double lane_weight;
+};
+
+/*
+ * Cost of an ego stage in the layout of the external function: adds f to
+ * *F, writes the gradient to NABLA_F and the Gauss-Newton Hessian to H
+ * (kEgoStageVars x kEgoStageVars, column major). Any output may be nullptr.
+ */
+void tracking_cost(const double z[kEgoStageVars], const double* p, double* f, double* nabla_f, double* H);
+
+/* writes REFERENCE into the tracking parameters of one stage */
+void set_tracking_reference(double* stage_params, const TrackingReference& reference);
+
+/*
+ * The weights of two_obstacles_ego.m: inputs and lane as its stage cost, or,
+ * for the terminal stage, the pull to (X, Y) of model.objectiveN.
+ */
+TrackingReference lane_reference(double lane_radius = 1.5);
+TrackingReference goal_reference(double x, double y);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_TRACKING_COST_H */
@@ -0,0 +1,62 @@
+/*
+ * Planned trajectory: the stage variables of one solve and its diagnostics.
+ */
+
+#ifndef MPC_PLANNER_TRAJECTORY_H
+#define MPC_PLANNER_TRAJECTORY_H
+
+#include "mpc_planner/problem.h"
+
+namespace mpc_planner {
+
+struct Trajectory {
+    /* time of the state estimate the solve started from (steady clock, seconds) */
+    double stamp = 0;
+
+    /* time of each stage after stamp, seconds; kStepSize apart for FORCESNLPsolver, see time_grid.h */
+    double time[kStages];
+
+    /* stages in use; on a shrunk horizon the remaining ones repeat the last of them */
+    int stages = kStages;
+
+    /* solver exitflag, FORCESNLPsolver_OPTIMAL on success */
+    int exitflag = 0;
+
+    /* iterations and wall-clock time of the solve */
+    int iterations = 0;
+    double solvetime = 0;
+
+    /* emergency-stop plan published in place of a failed solve, see emergency_stop.h */
+    bool fallback = false;
+
+    /* stage variables, see problem.h */
+    double z[kStages][kStageVars] = {};
+
+    Trajectory() { set_uniform(kStepSize); }
+
+    const double* inputs(int k) const { return z[k]; }
+    const double* states(int k) const { return z[k] + kInputs; }
+
+    /* all stages in use, STEP apart */
+    void set_uniform(double step)
+    {
+        for (int k = 0; k < kStages; k++) time[k] = step * k;
+        stages = kStages;
+    }
+
+    /* the stage whose interval contains OFFSET seconds after stamp, clamped to the stages in use */
+    int stage_at(double offset) const
+    {
+        int lo = 0, hi = stages - 1;
+        if (offset >= time[hi]) return hi;
+        while (hi - lo > 1) {
+            int mid = (lo + hi) / 2;
+            if (time[mid] <= offset) lo = mid; else hi = mid;
+        }
+        return lo;
+    }
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_TRAJECTORY_H */
@@ -0,0 +1,105 @@
+/*
+ * References between the stages of the latest plan, for controllers running
+ * much faster than the 0.1 s stage spacing.
+ *
+ * publish() precomputes everything a query needs (ego states, inputs and the
+ * state derivatives at both ends of every stage interval), so sample() is a
+ * constant-time evaluation without allocation. Two interpolations are offered:
+ *
+ *   kHermite  cubic Hermite between the stage states, with the slopes of
+ *             car_dynamics at both ends of the interval; C1 and cheap
+ *   kRk4      one RK4 step of length t - t_k from stage k with the held input,
+ *             i.e. what the solver's own discretization predicts
+ *
+ * Inputs are held over a stage, as in the model. Non-uniform stage times are
+ * located through a bucket table built at publish time, so the lookup stays
+ * constant-time on any grid. Plans live in a small pool of slots and the
+ * current one is published by swapping an atomic pointer; readers pin a slot
+ * with a reference count while they read it, so a reader never blocks the
+ * publisher and never sees a slot that is being rewritten.
+ *
+ * One publisher, any number of readers.
+ */
+
+#ifndef MPC_PLANNER_TRAJECTORY_SERVICE_H
+#define MPC_PLANNER_TRAJECTORY_SERVICE_H
+
+#include <atomic>
+
+#include "mpc_planner/problem.h"
+#include "mpc_planner/trajectory.h"
+
+namespace mpc_planner {
+
+enum class Interpolation { kHermite, kRk4 };
+
+struct TrajectorySample {
+    /* ego states [x y v theta] and their time derivative */
+    double x[kCarStates] = {};
+    double dx[kCarStates] = {};
+
+    /* ego inputs [F s] */
+    double u[kCarInputs] = {};
+
+    /* stage the sample time falls into */
+    int stage = 0;
+
+    /* false if the sample time lies outside the horizon; the sample is then clamped to its ends */
+    bool in_horizon = false;
+};
+
+class TrajectoryService {
+public:
+    TrajectoryService() = default;
+
+    TrajectoryService(const TrajectoryService&) = delete;
+    TrajectoryService& operator=(const TrajectoryService&) = delete;
+
+    /* publisher: makes TRAJECTORY the current plan; false if every spare slot is still pinned by a reader */
+    bool publish(const Trajectory& trajectory, double mass = kMass, double inertia = kInertia);
+
+    /* reader: samples the current plan at steady clock time T; false if nothing was published yet */
+    bool sample(double t, TrajectorySample* out, Interpolation interpolation = Interpolation::kHermite) const;
+
+    /* reader: stamp of the current plan, 0 if nothing was published yet */
+    double stamp() const;
+
+    /* plans dropped by publish() because no slot was free */
+    long dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int kSlots = 4;
+    static constexpr int kBuckets = 4 * kStages;
+
+    struct Slot {
+        double stamp = 0;
+        double time[kStages] = {};
+        int stages = kStages;
+
+        /* first stage of each of kBuckets equal time intervals over the horizon */
+        double bucket_width = kStepSize;
+        int bucket_stage[kBuckets] = {};
+        double mass = kMass;
+        double inertia = kInertia;
+
+        double x[kStages][kCarStates] = {};
+        double u[kStages][kCarInputs] = {};
+
+        /* derivatives at the start and end of interval k, with input u[k] */
+        double dx_begin[kStages][kCarStates] = {};
+        double dx_end[kStages][kCarStates] = {};
+
+        mutable std::atomic<int> readers{0};
+    };
+
+    const Slot* acquire() const;
+    static void release(const Slot* slot) { slot->readers.fetch_sub(1, std::memory_order_release); }
+
+    Slot slots_[kSlots];
+    alignas(64) std::atomic<Slot*> current_{nullptr};
+    std::atomic<long> dropped_{0};
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_TRAJECTORY_SERVICE_H */
@@ -0,0 +1,68 @@
+/*
+ * Wait-free hand-off of the latest value from one writer to one reader.
+ *
+ * Double buffering with a spare slot: the writer fills its back buffer and
+ * swaps it with the middle one, the reader swaps the middle one with its
+ * front buffer whenever a fresh value is there. Both sides only ever touch
+ * their own buffer plus one atomic exchange, so neither side blocks and the
+ * reader never sees a half-written value. Intermediate values the reader did
+ * not pick up are dropped.
+ */
+
+#ifndef MPC_PLANNER_TRIPLE_BUFFER_H
+#define MPC_PLANNER_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace mpc_planner {
+
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle_(1), back_(0), front_(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /* writer: buffer to fill before publish() */
+    T& back() { return slots_[back_]; }
+
+    /* writer: makes back() visible to the reader */
+    void publish()
+    {
+        back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex;
+    }
+
+    /* writer: copies VALUE into back() and publishes it */
+    void write(const T& value)
+    {
+        back() = value;
+        publish();
+    }
+
+    /* reader: picks up the latest published value, returns false if there was none since the last call */
+    bool update()
+    {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+
+    /* reader: the value picked up by the last update() */
+    const T& front() const { return slots_[front_]; }
+
+private:
+    static constexpr std::uint8_t kIndex = 0x3;
+    static constexpr std::uint8_t kFresh = 0x4;
+
+    T slots_[3];
+    /* on separate cache lines, the writer and reader run on different cores */
+    alignas(64) std::atomic<std::uint8_t> middle_;
+    alignas(64) std::uint8_t back_;   /* writer only */
+    alignas(64) std::uint8_t front_;  /* reader only */
+};
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_TRIPLE_BUFFER_H */
@@ -0,0 +1,35 @@
+/*
+ * Continuous dynamics of the cars in two_abstacles.m and their explicit RK4
+ * discretization, i.e. what model.eq imposes between two stages.
+ *
+ * A car has the states [x y v theta] and the inputs [F s]:
+ *   dx/dt = v*cos(theta), dy/dt = v*sin(theta), dv/dt = F/m, dtheta/dt = s/I
+ * Obstacles use the same model with m = I = 1.
+ */
+
+#ifndef MPC_PLANNER_VEHICLE_MODEL_H
+#define MPC_PLANNER_VEHICLE_MODEL_H
+
+#include "mpc_planner/problem.h"
+
+namespace mpc_planner {
+
+/* time derivative of one car */
+void car_dynamics(const double x[kCarStates], const double u[kCarInputs], double m, double I,
+                  double dx[kCarStates]);
+
+/* Jacobians of car_dynamics, A = d(dx)/dx and B = d(dx)/du */
+void car_jacobian(const double x[kCarStates], double m, double I, double A[kCarStates][kCarStates],
+                  double B[kCarStates][kCarInputs]);
+
+/* one RK4 step of length h for one car */
+void car_rk4(const double x[kCarStates], const double u[kCarInputs], double m, double I, double h,
+             double x_next[kCarStates]);
+
+/* one RK4 step of the full model (ego and obstacles), P = [m I] */
+void model_rk4(const double x[kStates], const double u[kInputs], const double p[kStageParams], double h,
+               double x_next[kStates]);
+
+}  /* namespace mpc_planner */
+
+#endif  /* MPC_PLANNER_VEHICLE_MODEL_H */
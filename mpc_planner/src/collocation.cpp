@@ -0,0 +1,226 @@
+#include "mpc_planner/collocation.h"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "mpc_planner/vehicle_model.h"
+
+namespace mpc_planner {
+
+namespace {
+
+constexpr int kMaxUnknowns = kMaxCollocationPoints * kCarStates;
+
+struct Tableau {
+    int points;
+    double a[kMaxCollocationPoints][kMaxCollocationPoints];
+    double b[kMaxCollocationPoints];
+};
+
+Tableau make_tableau(Collocation method)
+{
+    Tableau t = {};
+    if (method == Collocation::kGaussLegendre2) {
+        const double r3 = std::sqrt(3.0);
+        t.points = 2;
+        t.a[0][0] = 0.25;              t.a[0][1] = 0.25 - r3 / 6;
+        t.a[1][0] = 0.25 + r3 / 6;     t.a[1][1] = 0.25;
+        t.b[0] = t.b[1] = 0.5;
+    } else if (method == Collocation::kGaussLegendre3) {
+        const double r15 = std::sqrt(15.0);
+        t.points = 3;
+        t.a[0][0] = 5.0 / 36;             t.a[0][1] = 2.0 / 9 - r15 / 15;  t.a[0][2] = 5.0 / 36 - r15 / 30;
+        t.a[1][0] = 5.0 / 36 + r15 / 24;  t.a[1][1] = 2.0 / 9;             t.a[1][2] = 5.0 / 36 - r15 / 24;
+        t.a[2][0] = 5.0 / 36 + r15 / 30;  t.a[2][1] = 2.0 / 9 + r15 / 15;  t.a[2][2] = 5.0 / 36;
+        t.b[0] = 5.0 / 18;
+        t.b[1] = 4.0 / 9;
+        t.b[2] = 5.0 / 18;
+    } else {
+        const double r6 = std::sqrt(6.0);
+        t.points = 3;
+        t.a[0][0] = (88 - 7 * r6) / 360;     t.a[0][1] = (296 - 169 * r6) / 1800;  t.a[0][2] = (-2 + 3 * r6) / 225;
+        t.a[1][0] = (296 + 169 * r6) / 1800; t.a[1][1] = (88 + 7 * r6) / 360;      t.a[1][2] = (-2 - 3 * r6) / 225;
+        t.a[2][0] = (16 - r6) / 36;          t.a[2][1] = (16 + r6) / 36;           t.a[2][2] = 1.0 / 9;
+        /* stiffly accurate: b is the last row of a */
+        for (int j = 0; j < 3; j++) t.b[j] = t.a[2][j];
+    }
+    return t;
+}
+
+const Tableau& tableau(Collocation method)
+{
+    static const Tableau tableaus[] = {
+        make_tableau(Collocation::kGaussLegendre2),
+        make_tableau(Collocation::kGaussLegendre3),
+        make_tableau(Collocation::kRadauIIA3),
+    };
+    return tableaus[static_cast<int>(method)];
+}
+
+/* LU factorization with partial pivoting of the N x N matrix M, in place */
+bool lu_factor(double m[kMaxUnknowns][kMaxUnknowns], int n, int pivot[kMaxUnknowns])
+{
+    for (int k = 0; k < n; k++) {
+        int p = k;
+        for (int i = k + 1; i < n; i++) {
+            if (std::fabs(m[i][k]) > std::fabs(m[p][k])) p = i;
+        }
+        if (m[p][k] == 0) return false;
+        pivot[k] = p;
+        if (p != k) {
+            for (int j = 0; j < n; j++) std::swap(m[k][j], m[p][j]);
+        }
+        for (int i = k + 1; i < n; i++) {
+            m[i][k] /= m[k][k];
+            for (int j = k + 1; j < n; j++) m[i][j] -= m[i][k] * m[k][j];
+        }
+    }
+    return true;
+}
+
+void lu_solve(const double m[kMaxUnknowns][kMaxUnknowns], int n, const int pivot[kMaxUnknowns], double x[kMaxUnknowns])
+{
+    for (int k = 0; k < n; k++) {
+        std::swap(x[k], x[pivot[k]]);
+        for (int i = k + 1; i < n; i++) x[i] -= m[i][k] * x[k];
+    }
+    for (int k = n - 1; k >= 0; k--) {
+        for (int j = k + 1; j < n; j++) x[k] -= m[k][j] * x[j];
+        x[k] /= m[k][k];
+    }
+}
+
+}  /* namespace */
+
+int collocation_order(Collocation method)
+{
+    switch (method) {
+    case Collocation::kGaussLegendre2: return 4;
+    case Collocation::kGaussLegendre3: return 6;
+    case Collocation::kRadauIIA3: return 5;
+    }
+    return 0;
+}
+
+bool car_collocation(const CollocationConfig& config, const double x[kCarStates], const double u[kCarInputs],
+                     double m, double I, double h, double x_next[kCarStates],
+                     double dx[kCarStates][kCarStates], double du[kCarStates][kCarInputs])
+{
+    const Tableau& t = tableau(config.method);
+    const int s = t.points;
+    const int n = s * kCarStates;
+
+    double K[kMaxCollocationPoints][kCarStates];
+    double X[kMaxCollocationPoints][kCarStates];
+    double J[kMaxCollocationPoints][kCarStates][kCarStates];
+    double B[kCarStates][kCarInputs];
+    double M[kMaxUnknowns][kMaxUnknowns];
+    int pivot[kMaxUnknowns];
+
+    double f0[kCarStates];
+    car_dynamics(x, u, m, I, f0);
+    for (int i = 0; i < s; i++) std::memcpy(K[i], f0, sizeof(f0));
+
+    /* builds the collocation points X_i and M = I - h (A (x) J_i) at the current K */
+    auto linearize = [&]() {
+        for (int i = 0; i < s; i++) {
+            for (int r = 0; r < kCarStates; r++) {
+                X[i][r] = x[r];
+                for (int j = 0; j < s; j++) X[i][r] += h * t.a[i][j] * K[j][r];
+            }
+            car_jacobian(X[i], m, I, J[i], B);
+        }
+        for (int i = 0; i < s; i++) {
+            for (int r = 0; r < kCarStates; r++) {
+                for (int j = 0; j < s; j++) {
+                    for (int q = 0; q < kCarStates; q++) {
+                        M[i * kCarStates + r][j * kCarStates + q] = (i == j && r == q) - h * t.a[i][j] * J[i][r][q];
+                    }
+                }
+            }
+        }
+        return lu_factor(M, n, pivot);
+    };
+
+    bool converged = false;
+    for (int it = 0; it < config.max_iterations && !converged; it++) {
+        if (!linearize()) break;
+        double step[kMaxUnknowns];
+        for (int i = 0; i < s; i++) {
+            double f[kCarStates];
+            car_dynamics(X[i], u, m, I, f);
+            for (int r = 0; r < kCarStates; r++) step[i * kCarStates + r] = f[r] - K[i][r];
+        }
+        lu_solve(M, n, pivot, step);
+        double largest = 0;
+        for (int i = 0; i < s; i++) {
+            for (int r = 0; r < kCarStates; r++) {
+                K[i][r] += step[i * kCarStates + r];
+                largest = std::fmax(largest, std::fabs(step[i * kCarStates + r]));
+            }
+        }
+        converged = largest <= config.tolerance;
+    }
+
+    for (int r = 0; r < kCarStates; r++) {
+        x_next[r] = x[r];
+        for (int i = 0; i < s; i++) x_next[r] += h * t.b[i] * K[i][r];
+    }
+    if (!converged || (!dx && !du)) return converged;
+
+    /* implicit function theorem at the converged K: M dK/dx = [J_i], M dK/du = [B] */
+    if (!linearize()) return false;
+    for (int col = 0; col < kCarStates + kCarInputs; col++) {
+        double rhs[kMaxUnknowns];
+        for (int i = 0; i < s; i++) {
+            for (int r = 0; r < kCarStates; r++) {
+                rhs[i * kCarStates + r] = col < kCarStates ? J[i][r][col] : B[r][col - kCarStates];
+            }
+        }
+        lu_solve(M, n, pivot, rhs);
+        for (int r = 0; r < kCarStates; r++) {
+            double d = col < kCarStates ? (r == col) : 0;
+            for (int i = 0; i < s; i++) d += h * t.b[i] * rhs[i * kCarStates + r];
+            if (col < kCarStates) {
+                if (dx) dx[r][col] = d;
+            } else if (du) {
+                du[r][col - kCarStates] = d;
+            }
+        }
+    }
+    return true;
+}
+
+bool ego_collocation(const CollocationConfig& config, const double z[kEgoStageVars], const double* p, double h,
+                     double c[kCarStates], double nabla_c[kCarStates * kEgoStageVars])
+{
+    double x_next[kCarStates];
+    double dx[kCarStates][kCarStates] = {}, du[kCarStates][kCarInputs] = {};
+    const double* u = z;
+    const double* x = z + kCarInputs;
+    bool converged = car_collocation(config, x, u, p[kParamMass], p[kParamInertia], h, x_next,
+                                     nabla_c ? dx : nullptr, nabla_c ? du : nullptr);
+    if (c) std::memcpy(c, x_next, sizeof(x_next));
+    if (nabla_c) {
+        for (int r = 0; r < kCarStates; r++) {
+            for (int j = 0; j < kCarInputs; j++) nabla_c[j * kCarStates + r] = du[r][j];
+            for (int j = 0; j < kCarStates; j++) nabla_c[(kCarInputs + j) * kCarStates + r] = dx[r][j];
+        }
+    }
+    return converged;
+}
+
+bool model_collocation(const CollocationConfig& config, const double x[kStates], const double u[kInputs],
+                       const double p[kStageParams], double h, double x_next[kStates])
+{
+    /* decoupled cars, as in model_rk4 */
+    bool converged = car_collocation(config, x, u, p[0], p[1], h, x_next);
+    for (int i = 1; i <= kObstacles; i++) {
+        converged = car_collocation(config, x + kCarStates * i, u + kCarInputs * i, 1, 1, h,
+                                    x_next + kCarStates * i) && converged;
+    }
+    return converged;
+}
+
+}  /* namespace mpc_planner */
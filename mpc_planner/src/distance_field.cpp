@@ -0,0 +1,176 @@
+#include "mpc_planner/distance_field.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mpc_planner {
+
+namespace {
+
+/* stands in for "no target cell", finite so that the envelope arithmetic stays exact */
+constexpr double kFar = 1e20;
+
+/*
+ * 1-D squared distance transform of F (Felzenszwalb and Huttenlocher): the
+ * lower envelope of the parabolas (q - v)^2 + F[v], written to D.
+ */
+void transform_line(const double* f, int n, double* d, int* v, double* z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -kFar;
+    z[1] = kFar;
+    for (int q = 1; q < n; q++) {
+        /* s > z[0] always: |f| <= kFar keeps the intersections within +-kFar / 2 */
+        auto intersection = [&](int r) { return ((f[q] + double(q) * q) - (f[r] + double(r) * r)) / (2.0 * (q - r)); };
+        double s = intersection(v[k]);
+        while (s <= z[k]) s = intersection(v[--k]);
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kFar;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < q) k++;
+        const double e = q - v[k];
+        d[q] = e * e + f[v[k]];
+    }
+}
+
+}  /* namespace */
+
+bool DistanceField::init(const DistanceFieldConfig& config)
+{
+    if (config.width <= 0 || config.height <= 0 || config.resolution <= 0) return false;
+    config_ = config;
+    tiles_x_ = (config.width + kTileMask) >> kTileBits;
+    const int tiles_y = (config.height + kTileMask) >> kTileBits;
+    reach_ = static_cast<int>(std::ceil(config.max_distance / config.resolution)) + 1;
+
+    const size_t cells = static_cast<size_t>(config.width) * config.height;
+    occupancy_.assign(cells, 0);
+    sdf_.assign(static_cast<size_t>(tiles_x_) * tiles_y << (2 * kTileBits), static_cast<float>(config.max_distance));
+    to_occupied_.resize(cells);
+    to_free_.resize(cells);
+    const int longest = std::max(config.width, config.height);
+    line_.resize(2 * longest);
+    envelope_.resize(longest + 1);
+    vertices_.resize(longest);
+    dirty_i0_ = dirty_j0_ = 0;
+    dirty_i1_ = dirty_j1_ = -1;
+    return true;
+}
+
+void DistanceField::set_occupied(int i, int j, bool occupied)
+{
+    if (i < 0 || j < 0 || i >= config_.width || j >= config_.height) return;
+    std::uint8_t& cell = occupancy_[static_cast<size_t>(j) * config_.width + i];
+    if (cell == occupied) return;
+    cell = occupied;
+    if (dirty_i0_ > dirty_i1_) {
+        dirty_i0_ = dirty_i1_ = i;
+        dirty_j0_ = dirty_j1_ = j;
+        return;
+    }
+    dirty_i0_ = std::min(dirty_i0_, i);
+    dirty_i1_ = std::max(dirty_i1_, i);
+    dirty_j0_ = std::min(dirty_j0_, j);
+    dirty_j1_ = std::max(dirty_j1_, j);
+}
+
+void DistanceField::set_occupied_at(double x, double y, bool occupied)
+{
+    set_occupied(static_cast<int>(std::floor((x - config_.origin_x) / config_.resolution)),
+                 static_cast<int>(std::floor((y - config_.origin_y) / config_.resolution)), occupied);
+}
+
+bool DistanceField::occupied(int i, int j) const
+{
+    if (i < 0 || j < 0 || i >= config_.width || j >= config_.height) return false;
+    return occupancy_[static_cast<size_t>(j) * config_.width + i];
+}
+
+void DistanceField::transform(bool target, int i0, int j0, int w, int h, std::vector<double>& out)
+{
+    double* f = line_.data();
+    double* d = line_.data() + line_.size() / 2;
+    for (int i = 0; i < w; i++) {
+        for (int j = 0; j < h; j++) f[j] = occupied(i0 + i, j0 + j) == target ? 0 : kFar;
+        transform_line(f, h, d, vertices_.data(), envelope_.data());
+        for (int j = 0; j < h; j++) out[static_cast<size_t>(j) * w + i] = d[j];
+    }
+    for (int j = 0; j < h; j++) {
+        double* row = out.data() + static_cast<size_t>(j) * w;
+        std::copy(row, row + w, f);
+        transform_line(f, w, row, vertices_.data(), envelope_.data());
+    }
+}
+
+long DistanceField::update()
+{
+    if (dirty_i0_ > dirty_i1_) return 0;
+
+    /* cells whose distance may have changed, and the occupancy they depend on */
+    const int oi0 = std::max(dirty_i0_ - reach_, 0), oi1 = std::min(dirty_i1_ + reach_, config_.width - 1);
+    const int oj0 = std::max(dirty_j0_ - reach_, 0), oj1 = std::min(dirty_j1_ + reach_, config_.height - 1);
+    const int wi0 = std::max(oi0 - reach_, 0), wi1 = std::min(oi1 + reach_, config_.width - 1);
+    const int wj0 = std::max(oj0 - reach_, 0), wj1 = std::min(oj1 + reach_, config_.height - 1);
+    const int w = wi1 - wi0 + 1, h = wj1 - wj0 + 1;
+    transform(true, wi0, wj0, w, h, to_occupied_);
+    transform(false, wi0, wj0, w, h, to_free_);
+
+    /* distances between cell centres, moved by half a cell onto the cell boundary */
+    const double res = config_.resolution, limit = config_.max_distance;
+    for (int j = oj0; j <= oj1; j++) {
+        for (int i = oi0; i <= oi1; i++) {
+            const size_t k = static_cast<size_t>(j - wj0) * w + (i - wi0);
+            double value = occupied(i, j) ? -(std::sqrt(to_free_[k]) * res - res / 2)
+                                          : std::sqrt(to_occupied_[k]) * res - res / 2;
+            sdf_[index(i, j)] = static_cast<float>(std::min(std::max(value, -limit), limit));
+        }
+    }
+
+    dirty_i0_ = dirty_j0_ = 0;
+    dirty_i1_ = dirty_j1_ = -1;
+    return static_cast<long>(oi1 - oi0 + 1) * (oj1 - oj0 + 1);
+}
+
+double DistanceField::distance(double x, double y, double grad[2]) const
+{
+    const double u = (x - config_.origin_x) / config_.resolution - 0.5;
+    const double v = (y - config_.origin_y) / config_.resolution - 0.5;
+    if (grad) grad[0] = grad[1] = 0;
+    if (!(u >= -0.5 && v >= -0.5 && u <= config_.width - 0.5 && v <= config_.height - 0.5)) {
+        return config_.max_distance;
+    }
+
+    /* the half cells along the border extend the outermost centres */
+    const int i0 = std::min(std::max(static_cast<int>(std::floor(u)), 0), std::max(config_.width - 2, 0));
+    const int j0 = std::min(std::max(static_cast<int>(std::floor(v)), 0), std::max(config_.height - 2, 0));
+    const int i1 = std::min(i0 + 1, config_.width - 1), j1 = std::min(j0 + 1, config_.height - 1);
+    const double fx = std::min(std::max(u - i0, 0.0), 1.0), fy = std::min(std::max(v - j0, 0.0), 1.0);
+
+    const double v00 = sdf_[index(i0, j0)], v10 = sdf_[index(i1, j0)];
+    const double v01 = sdf_[index(i0, j1)], v11 = sdf_[index(i1, j1)];
+    if (grad) {
+        /* where fx or fy is clamped the value is constant along that axis */
+        if (fx == u - i0) grad[0] = ((1 - fy) * (v10 - v00) + fy * (v11 - v01)) / config_.resolution;
+        if (fy == v - j0) grad[1] = ((1 - fx) * (v01 - v00) + fx * (v11 - v10)) / config_.resolution;
+    }
+    return (1 - fy) * ((1 - fx) * v00 + fx * v10) + fy * ((1 - fx) * v01 + fx * v11);
+}
+
+void ego_clearance(const DistanceField& field, const double z[kEgoStageVars], int row, int nh, double* h,
+                   double* nabla_h)
+{
+    double grad[2];
+    double value = field.distance(z[kCarInputs], z[kCarInputs + 1], grad);
+    if (h) h[row] = value;
+    if (nabla_h) {
+        nabla_h[kCarInputs * nh + row] = grad[0];
+        nabla_h[(kCarInputs + 1) * nh + row] = grad[1];
+    }
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,51 @@
+#include "mpc_planner/emergency_stop.h"
+
+#include <cstring>
+
+#include "mpc_planner/initial_guess.h"
+#include "mpc_planner/vehicle_model.h"
+
+namespace mpc_planner {
+
+bool emergency_stop(const double x[kStates], double stamp, Trajectory* out)
+{
+    const double u_obstacle[kCarInputs] = { 0, 0 };
+    double state[kStates];
+    std::memcpy(state, x, sizeof(state));
+    bool feasible = true;
+
+    for (int k = 0; k < kStages; k++) {
+        double* z = out->z[k];
+        std::memset(z, 0, sizeof(double) * kInputs);
+        z[kForce] = braking_force(state[kV], kMass, kStepSize);
+        z[kSteer] = 0;
+        std::memcpy(z + kInputs, state, sizeof(state));
+
+        for (int i = 0; i < kCarInputs + kCarStates; i++) {
+            int index = i < kCarInputs ? i : kInputs + i - kCarInputs;
+            if (z[index] < kLowerBounds[index] || z[index] > kUpperBounds[index]) feasible = false;
+        }
+
+        /* car_dyanmics takes [F s x y v theta] */
+        double ego[kCarInputs + kCarStates] = { z[kForce], z[kSteer], state[kX], state[kY], state[kV], state[kTheta] };
+        car_dyanmics(ego, state);
+        /* clamp the rounding of the last braking step */
+        if (state[kV] < 0) state[kV] = 0;
+
+        for (int i = 1; i <= kObstacles; i++) {
+            double next[kCarStates];
+            car_rk4(state + kCarStates * i, u_obstacle, 1, 1, kStepSize, next);
+            std::memcpy(state + kCarStates * i, next, sizeof(next));
+        }
+    }
+
+    out->stamp = stamp;
+    out->set_uniform(kStepSize);
+    out->exitflag = 0;
+    out->iterations = 0;
+    out->solvetime = 0;
+    out->fallback = true;
+    return feasible;
+}
+
+}  /* namespace mpc_planner */
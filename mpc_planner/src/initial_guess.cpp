@@ -0,0 +1,105 @@
+#include "mpc_planner/initial_guess.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "mpc_planner/vehicle_model.h"
+
+namespace mpc_planner {
+
+static double clamp_variable(double value, int index)
+{
+    return std::min(std::max(value, kLowerBounds[index]), kUpperBounds[index]);
+}
+
+/* rolls the model forward from XINIT with the ego inputs chosen by POLICY(k, x, u) */
+template <typename Policy>
+static void rollout(const double xinit[kStates], Policy policy, double x0[kGuessSize])
+{
+    const double p[kStageParams] = { kMass, kInertia };
+    double x[kStates], x_next[kStates];
+    std::memcpy(x, xinit, sizeof(x));
+
+    for (int k = 0; k < kStages; k++) {
+        double u[kInputs] = {};
+        policy(k, x, u);
+        u[kForce] = clamp_variable(u[kForce], kForce);
+        u[kSteer] = clamp_variable(u[kSteer], kSteer);
+
+        double* z = x0 + kStageVars * k;
+        std::memcpy(z, u, sizeof(u));
+        std::memcpy(z + kInputs, x, sizeof(x));
+
+        model_rk4(x, u, p, kStepSize, x_next);
+        std::memcpy(x, x_next, sizeof(x));
+    }
+}
+
+double braking_force(double v, double mass, double step)
+{
+    /* dv/dt = F/m is linear, so RK4 reaches exactly v + F/m*step */
+    return std::max(kLowerBounds[kForce], -std::max(v, 0.0) * mass / step);
+}
+
+void guess_midpoint(double x0[kGuessSize])
+{
+    for (int k = 0; k < kStages; k++) {
+        for (int i = 0; i < kStageVars; i++) {
+            x0[kStageVars * k + i] = kLowerBounds[i] + (kUpperBounds[i] - kLowerBounds[i]) / 2;
+        }
+    }
+}
+
+void guess_shifted(const Trajectory& previous, int shift, double x0[kGuessSize])
+{
+    shift = std::max(0, shift);
+    for (int k = 0; k < kStages; k++) {
+        int src = std::min(k + shift, kStages - 1);
+        std::memcpy(x0 + kStageVars * k, previous.z[src], sizeof(double) * kStageVars);
+    }
+}
+
+void guess_resampled(const Trajectory& previous, double elapsed, const double time[kStages],
+                     double x0[kGuessSize])
+{
+    const int last = previous.stages - 1;
+    for (int k = 0; k < kStages; k++) {
+        const double t = elapsed + time[k];
+        const int j = previous.stage_at(t);
+        double* z = x0 + kStageVars * k;
+        std::memcpy(z, previous.inputs(j), sizeof(double) * kInputs);
+
+        if (j >= last) {
+            std::memcpy(z + kInputs, previous.states(last), sizeof(double) * kStates);
+            continue;
+        }
+        const double span = previous.time[j + 1] - previous.time[j];
+        const double alpha = span > 0 ? std::min(std::max((t - previous.time[j]) / span, 0.0), 1.0) : 0;
+        for (int i = 0; i < kStates; i++) {
+            z[kInputs + i] = (1 - alpha) * previous.states(j)[i] + alpha * previous.states(j + 1)[i];
+        }
+    }
+}
+
+void guess_braking(const double xinit[kStates], double x0[kGuessSize])
+{
+    rollout(xinit, [](int, const double* x, double* u) {
+        u[kForce] = braking_force(x[kV], kMass, kStepSize);
+    }, x0);
+}
+
+void guess_lane_keep(const double xinit[kStates], double x0[kGuessSize])
+{
+    /* direction of travel around the origin: +1 counter-clockwise, -1 clockwise */
+    const double turn = xinit[kX] * std::sin(xinit[kTheta]) - xinit[kY] * std::cos(xinit[kTheta]) >= 0 ? 1 : -1;
+
+    rollout(xinit, [turn](int, const double* x, double* u) {
+        /* curvature of the lane plus a correction towards it */
+        double radius = std::hypot(x[kX], x[kY]);
+        double rate = turn * x[kV] / kLaneRadius + turn * (radius - kLaneRadius);
+        u[kSteer] = kInertia * rate;
+    }, x0);
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,145 @@
+#include "mpc_planner/iteration_telemetry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace mpc_planner {
+
+/* telemetry recording on this thread, between begin() and end() */
+static thread_local IterationTelemetry* current_telemetry = nullptr;
+
+static double seconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void IterationTelemetry::begin(FORCESNLPsolver_ExtFunc model)
+{
+    model_ = model;
+    open_ = nullptr;
+    totals_ = PhaseTimes();
+    counted_ = PhaseCounters();
+    iterations_ = 0;
+    derivatives_ = false;
+    in_sweep_ = false;
+    sweep_end_ = 0;
+    have_defect_ = false;
+    solves_++;
+    current_telemetry = this;
+}
+
+void IterationTelemetry::end()
+{
+    if (in_sweep_) end_sweep();
+    if (sweep_end_ > 0) add_gap(seconds());
+    open_ = nullptr;
+    if (current_telemetry == this) current_telemetry = nullptr;
+}
+
+void IterationTelemetry::ext_func(double* x, double* y, double* l, double* p, double* f, double* nabla_f, double* c,
+                                  double* nabla_c, double* h, double* nabla_h, double* H, int stage)
+{
+    IterationTelemetry* telemetry = current_telemetry;
+    if (telemetry) telemetry->evaluate(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, H, stage);
+}
+
+int IterationTelemetry::size() const
+{
+    return static_cast<int>(std::min<unsigned long>(written_, kTelemetryCapacity));
+}
+
+const IterationRecord& IterationTelemetry::at(int i) const
+{
+    return records_[(written_ - size() + i) % kTelemetryCapacity];
+}
+
+void IterationTelemetry::evaluate(double* x, double* y, double* l, double* p, double* f, double* nabla_f, double* c,
+                                  double* nabla_c, double* h, double* nabla_h, double* H, int stage)
+{
+    if (stage == 0) begin_sweep(nabla_f || nabla_c || nabla_h);
+
+    /* the model adds the stage cost to *f */
+    const double f_before = f ? *f : 0;
+    model_(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, H, stage);
+    if (derivatives_ && open_) measure(x, f ? *f - f_before : 0, c, h, stage);
+
+    if (stage == kStages - 1 && in_sweep_) end_sweep();
+}
+
+void IterationTelemetry::begin_sweep(bool derivatives)
+{
+    const double now = seconds();
+    if (in_sweep_) end_sweep();
+    if (sweep_end_ > 0) {
+        add_gap(now);
+    } else {
+        count_since_mark();
+    }
+
+    if (derivatives) {
+        open_ = &records_[written_++ % kTelemetryCapacity];
+        *open_ = IterationRecord();
+        open_->solve = solves_;
+        open_->iteration = iterations_++;
+        have_defect_ = false;
+    } else if (open_) {
+        open_->linesearch_steps++;
+    }
+    derivatives_ = derivatives;
+    in_sweep_ = true;
+    sweep_start_ = now;
+}
+
+void IterationTelemetry::end_sweep()
+{
+    const double now = seconds();
+    totals_.feval += now - sweep_start_;
+    if (open_) open_->time.feval += now - sweep_start_;
+    counted_.feval += count_since_mark();
+    in_sweep_ = false;
+    sweep_end_ = now;
+}
+
+/* time since the last sweep, to the phase that followed it */
+void IterationTelemetry::add_gap(double now)
+{
+    const double gap = now - sweep_end_;
+    double& total = derivatives_ ? totals_.factor : totals_.linesearch;
+    total += gap;
+    if (open_) (derivatives_ ? open_->time.factor : open_->time.linesearch) += gap;
+    (derivatives_ ? counted_.factor : counted_.linesearch) += count_since_mark();
+    sweep_end_ = now;
+}
+
+CounterValues IterationTelemetry::count_since_mark()
+{
+    CounterValues delta;
+    if (!counters_ || !counters_->is_open()) return delta;
+    const CounterValues now = counters_->read();
+    for (int i = 0; i < kPerfEvents; i++) delta.value[i] = now.value[i] - mark_.value[i];
+    mark_ = now;
+    return delta;
+}
+
+void IterationTelemetry::measure(const double* x, double f, const double* c, const double* h, int stage)
+{
+    open_->objective += f;
+
+    if (have_defect_ && stage > 0) {
+        for (int i = 0; i < kStates; i++) {
+            open_->res_eq = std::max(open_->res_eq, std::fabs(defect_[i] - x[kInputs + i]));
+        }
+    }
+    have_defect_ = c != nullptr && stage < kStages - 1;
+    if (have_defect_) std::memcpy(defect_, c, sizeof(defect_));
+
+    if (h) {
+        for (int i = 0; i < kIneqs; i++) {
+            open_->res_ineq = std::max(open_->res_ineq, std::max(kIneqLower[i] - h[i], h[i] - kIneqUpper[i]));
+        }
+    }
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,206 @@
+#include "mpc_planner/multi_start.h"
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace mpc_planner {
+
+struct MultiStartSolver::Library {
+    using Solve = int (*)(FORCESNLPsolver_params*, FORCESNLPsolver_output*, FORCESNLPsolver_info*, std::FILE*,
+                          FORCESNLPsolver_ExtFunc);
+
+    void* handle = nullptr;
+    Solve solve = nullptr;
+    FORCESNLPsolver_ExtFunc ext_func = nullptr;
+    void (*set_deadline)(double) = nullptr;
+    void (*cancel)() = nullptr;
+
+    ~Library()
+    {
+        if (handle) dlclose(handle);
+    }
+};
+
+static bool copy_file(const std::string& from, const std::string& to)
+{
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary);
+    out << in.rdbuf();
+    return in && out;
+}
+
+MultiStartSolver::MultiStartSolver(const MultiStartConfig& config) : config_(config)
+{
+    for (int k = 0; k < kStages; k++) {
+        all_parameters_[kStageParams * k] = kMass;
+        all_parameters_[kStageParams * k + 1] = kInertia;
+    }
+
+    std::string library = config_.library;
+#ifdef MPC_PLANNER_FORCESNLPSOLVER_LIBRARY
+    if (library.empty()) library = MPC_PLANNER_FORCESNLPSOLVER_LIBRARY;
+#endif
+    if (library.empty()) {
+        error_ = "no FORCESNLPsolver library given";
+        return;
+    }
+
+    const char* tmp = std::getenv("TMPDIR");
+    std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") + "/mpc_planner_XXXXXX";
+    if (!mkdtemp(&pattern[0])) {
+        error_ = "cannot create a directory for the library copies";
+        return;
+    }
+
+    /* a copy per worker: the same path would be loaded only once, workspace included */
+    for (int i = 0; i < config_.workers && error_.empty(); i++) {
+        std::string copy = pattern + "/FORCESNLPsolver_" + std::to_string(i) + ".so";
+        std::unique_ptr<Library> lib(new Library);
+        if (!copy_file(library, copy)) {
+            error_ = "cannot copy " + library;
+        } else if (!(lib->handle = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL))) {
+            error_ = dlerror();
+        } else {
+            lib->solve = reinterpret_cast<Library::Solve>(dlsym(lib->handle, "FORCESNLPsolver_solve"));
+            lib->ext_func = reinterpret_cast<FORCESNLPsolver_ExtFunc>(
+                dlsym(lib->handle, "FORCESNLPsolver_casadi2forces_deadline"));
+            lib->set_deadline = reinterpret_cast<void (*)(double)>(dlsym(lib->handle, "FORCESNLPsolver_set_deadline"));
+            lib->cancel = reinterpret_cast<void (*)()>(dlsym(lib->handle, "FORCESNLPsolver_cancel"));
+            if (!lib->solve || !lib->ext_func || !lib->set_deadline || !lib->cancel) {
+                error_ = library + " lacks the deadline interface";
+            }
+        }
+        unlink(copy.c_str());
+
+        if (error_.empty()) {
+            std::unique_ptr<Worker> worker(new Worker);
+            worker->library = std::move(lib);
+            worker->log = std::fopen("/dev/null", "w");
+            workers_.push_back(std::move(worker));
+        }
+    }
+    rmdir(pattern.c_str());
+
+    for (int i = 0; i < workers(); i++) workers_[i]->thread = std::thread(&MultiStartSolver::run, this, i);
+    ok_ = error_.empty() && !workers_.empty();
+}
+
+MultiStartSolver::~MultiStartSolver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) worker->thread.join();
+        if (worker->log) std::fclose(worker->log);
+    }
+}
+
+void MultiStartSolver::run(int index)
+{
+    Worker& worker = *workers_[index];
+    unsigned long seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return quit_ || (worker.busy && generation_ != seen); });
+            if (quit_) return;
+            seen = generation_;
+        }
+
+        /* arming clears a cancel, so check for a winner only afterwards */
+        worker.library->set_deadline(config_.deadline);
+        bool skip;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            skip = decided_;
+        }
+        int exitflag = 0;
+        if (!skip) {
+            exitflag = worker.library->solve(&worker.params, &worker.output, &worker.info, worker.log,
+                                             worker.library->ext_func);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            worker.exitflag = exitflag;
+            worker.ran = !skip;
+            worker.busy = false;
+            if (!skip && exitflag == FORCESNLPsolver_OPTIMAL && !decided_) {
+                decided_ = true;
+                first_ = index;
+                for (auto& other : workers_) {
+                    if (other->busy) other->library->cancel();
+                }
+            }
+            running_--;
+        }
+        done_.notify_one();
+    }
+}
+
+bool MultiStartSolver::better(const Worker& a, const Worker& b) const
+{
+    auto rank = [](int exitflag) {
+        return exitflag == FORCESNLPsolver_OPTIMAL ? 2 : exitflag == FORCESNLPsolver_MAXITREACHED ? 1 : 0;
+    };
+    if (rank(a.exitflag) != rank(b.exitflag)) return rank(a.exitflag) > rank(b.exitflag);
+    return a.info.pobj < b.info.pobj;
+}
+
+int MultiStartSolver::solve(const double xinit[kStates], const double* const* guesses, int count, Trajectory* out,
+                            int* winner)
+{
+    if (!ok_ || count <= 0) return kMultiStartUnavailable;
+    count = std::min(count, workers());
+
+    for (int i = 0; i < count; i++) {
+        Worker& worker = *workers_[i];
+        std::memcpy(worker.params.xinit, xinit, sizeof(worker.params.xinit));
+        std::memcpy(worker.params.x0, guesses[i], sizeof(worker.params.x0));
+        std::memcpy(worker.params.all_parameters, all_parameters_, sizeof(worker.params.all_parameters));
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (int i = 0; i < count; i++) workers_[i]->busy = true;
+        generation_++;
+        running_ = count;
+        first_ = -1;
+        decided_ = false;
+        wake_.notify_all();
+        /* the cancelled attempts stop within one iteration of the winner */
+        done_.wait(lock, [&] { return running_ == 0; });
+    }
+
+    /* the first optimal one, or else the best of those that ran */
+    int best = first_;
+    if (best < 0) {
+        for (int i = 0; i < count; i++) {
+            if (workers_[i]->ran && (best < 0 || better(*workers_[i], *workers_[best]))) best = i;
+        }
+    }
+    if (winner) *winner = best;
+    if (best < 0) return kMultiStartUnavailable;
+
+    const Worker& worker = *workers_[best];
+    if (out) {
+        std::memcpy(out->z, &worker.output, sizeof(out->z));
+        out->exitflag = worker.exitflag;
+        out->iterations = worker.info.it;
+        out->solvetime = worker.info.solvetime;
+        out->set_uniform(kStepSize);
+        out->fallback = false;
+    }
+    return worker.exitflag;
+}
+
+}  /* namespace mpc_planner */
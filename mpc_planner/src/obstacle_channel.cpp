@@ -0,0 +1,109 @@
+#include "mpc_planner/obstacle_channel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "mpc_planner/vehicle_model.h"
+
+namespace mpc_planner {
+
+bool ObstacleChannel::update(int id, const double x[kCarStates])
+{
+    for (int i = 0; i < working_.count; i++) {
+        if (working_.obstacles[i].id == id) {
+            std::memcpy(working_.obstacles[i].x, x, sizeof(working_.obstacles[i].x));
+            return true;
+        }
+    }
+    if (working_.count == kMaxTrackedObstacles) return false;
+    ObstacleState& obstacle = working_.obstacles[working_.count++];
+    obstacle.id = id;
+    std::memcpy(obstacle.x, x, sizeof(obstacle.x));
+    return true;
+}
+
+void ObstacleChannel::remove(int id)
+{
+    for (int i = 0; i < working_.count; i++) {
+        if (working_.obstacles[i].id == id) {
+            working_.obstacles[i] = working_.obstacles[--working_.count];
+            return;
+        }
+    }
+}
+
+void ObstacleChannel::publish(double stamp)
+{
+    working_.stamp = stamp;
+    /* only the used part of the set is copied */
+    ObstacleSet& back = buffer_.back();
+    back.stamp = working_.stamp;
+    back.published = true;
+    back.count = working_.count;
+    std::copy(working_.obstacles, working_.obstacles + working_.count, back.obstacles);
+    buffer_.publish();
+}
+
+const ObstacleSet& ObstacleChannel::snapshot(bool* fresh)
+{
+    bool updated = buffer_.update();
+    if (fresh) *fresh = updated;
+    return buffer_.front();
+}
+
+ObstacleSlots::ObstacleSlots()
+{
+    std::fill(ids_, ids_ + kObstacles, -1);
+    std::fill(index_, index_ + kObstacles, -1);
+}
+
+void ObstacleSlots::assign(const ObstacleSet& set)
+{
+    bool placed[kMaxTrackedObstacles] = {};
+
+    /* obstacles still in the set keep their slot */
+    for (int slot = 0; slot < kObstacles; slot++) {
+        index_[slot] = -1;
+        for (int i = 0; i < set.count && ids_[slot] >= 0; i++) {
+            if (set.obstacles[i].id == ids_[slot]) {
+                index_[slot] = i;
+                placed[i] = true;
+                break;
+            }
+        }
+        if (index_[slot] < 0) ids_[slot] = -1;
+    }
+
+    /* the others fill the free slots */
+    int i = 0;
+    for (int slot = 0; slot < kObstacles; slot++) {
+        if (ids_[slot] >= 0) continue;
+        while (i < set.count && placed[i]) i++;
+        if (i == set.count) break;
+        ids_[slot] = set.obstacles[i].id;
+        index_[slot] = i;
+        placed[i] = true;
+    }
+}
+
+void write_obstacle_states(const ObstacleSet& set, double stamp, ObstacleSlots* slots, double xinit[kStates])
+{
+    if (!set.published) return;
+    const double u[kCarInputs] = { 0, 0 };
+    const double dt = std::max(0.0, stamp - set.stamp);
+
+    slots->assign(set);
+    for (int slot = 0; slot < kObstacles; slot++) {
+        double* x = xinit + kCarStates * (slot + 1);
+        const int i = slots->index(slot);
+        if (i < 0) {
+            std::memcpy(x, kParkedObstacles[slot], sizeof(double) * kCarStates);
+        } else if (dt > 0) {
+            car_rk4(set.obstacles[i].x, u, 1, 1, dt, x);
+        } else {
+            std::memcpy(x, set.obstacles[i].x, sizeof(double) * kCarStates);
+        }
+    }
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,189 @@
+#include "mpc_planner/obstacle_manager.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mpc_planner/obstacle_predictor.h"
+#include "mpc_planner/vehicle_model.h"
+
+namespace mpc_planner {
+
+ObstacleManager::ObstacleManager(const ObstacleManagerConfig& config) : config_(config)
+{
+    for (int w = 0; w < kWindows; w++) {
+        std::fill(start_[w], start_[w] + kBuckets + 1, 0);
+        wide_count_[w] = 0;
+    }
+    for (int k = 0; k < kStages; k++) std::fill(active_[k], active_[k] + kObstacleSlots, -1);
+}
+
+int ObstacleManager::cell(double v) const
+{
+    /* coordinates from perception may be huge or not finite; NaN ends up in the lowest cell */
+    const double c = std::floor(v / config_.cell_size);
+    if (!(c > -kMaxCell)) return -kMaxCell;
+    if (c > kMaxCell) return kMaxCell;
+    return static_cast<int>(c);
+}
+
+int ObstacleManager::bucket(int ix, int iy)
+{
+    unsigned h = static_cast<unsigned>(ix) * 73856093u ^ static_cast<unsigned>(iy) * 19349663u;
+    return static_cast<int>(h & (kBuckets - 1));
+}
+
+ObstacleManager::CellRange ObstacleManager::sweep(int obstacle, int window) const
+{
+    const int k0 = window * kWindow;
+    const int k1 = std::min(k0 + kWindow, kStages);
+    double x0 = poses_[obstacle][k0][kPoseX], x1 = x0;
+    double y0 = poses_[obstacle][k0][kPoseY], y1 = y0;
+    for (int k = k0 + 1; k < k1; k++) {
+        x0 = std::min(x0, poses_[obstacle][k][kPoseX]);
+        x1 = std::max(x1, poses_[obstacle][k][kPoseX]);
+        y0 = std::min(y0, poses_[obstacle][k][kPoseY]);
+        y1 = std::max(y1, poses_[obstacle][k][kPoseY]);
+    }
+    return { cell(x0), cell(y0), cell(x1), cell(y1) };
+}
+
+void ObstacleManager::update(const ObstacleSet& set, double stamp, double step)
+{
+    const double u[kCarInputs] = { 0, 0 };
+    const double dt = std::max(0.0, stamp - set.stamp);
+    count_ = set.count;
+
+    for (int i = 0; i < count_; i++) {
+        double x[kCarStates];
+        if (dt > 0) {
+            car_rk4(set.obstacles[i].x, u, 1, 1, dt, x);
+        } else {
+            std::copy(set.obstacles[i].x, set.obstacles[i].x + kCarStates, x);
+        }
+        /* at zero input speed and heading are constant and RK4 is exact: a straight line */
+        const double vx = x[kV] * std::cos(x[kTheta]) * step;
+        const double vy = x[kV] * std::sin(x[kTheta]) * step;
+        for (int k = 0; k < kStages; k++) {
+            poses_[i][k][kPoseX] = x[kX] + vx * k;
+            poses_[i][k][kPoseY] = x[kY] + vy * k;
+            poses_[i][k][kPoseTheta] = x[kTheta];
+        }
+    }
+
+    /* counting sort of the sweeps into the buckets, one pass to count and one to fill */
+    for (int w = 0; w < kWindows; w++) {
+        int* start = start_[w];
+        std::fill(start, start + kBuckets + 1, 0);
+        wide_count_[w] = 0;
+
+        for (int i = 0; i < count_; i++) {
+            CellRange r = sweep(i, w);
+            long cells = static_cast<long>(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1);
+            if (cells > kMaxSweepCells) {
+                wide_[w][wide_count_[w]++] = i;
+                continue;
+            }
+            for (int ix = r.x0; ix <= r.x1; ix++) {
+                for (int iy = r.y0; iy <= r.y1; iy++) start[bucket(ix, iy) + 1]++;
+            }
+        }
+        for (int b = 0; b < kBuckets; b++) start[b + 1] += start[b];
+
+        int fill[kBuckets];
+        std::copy(start, start + kBuckets, fill);
+        for (int i = 0; i < count_; i++) {
+            CellRange r = sweep(i, w);
+            long cells = static_cast<long>(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1);
+            if (cells > kMaxSweepCells) continue;
+            for (int ix = r.x0; ix <= r.x1; ix++) {
+                for (int iy = r.y0; iy <= r.y1; iy++) entries_[w][fill[bucket(ix, iy)]++] = i;
+            }
+        }
+    }
+}
+
+void ObstacleManager::select(int k, const double ego[2])
+{
+    if (++query_ == 0) {
+        std::fill(visited_, visited_ + kMaxTrackedObstacles, 0u);
+        query_ = 1;
+    }
+
+    const double range2 = config_.range * config_.range;
+    int nearest[kObstacleSlots];
+    double distance2[kObstacleSlots];
+    int found = 0;
+
+    auto consider = [&](int i) {
+        if (visited_[i] == query_) return;
+        visited_[i] = query_;
+        candidates_++;
+        double dx = poses_[i][k][kPoseX] - ego[0];
+        double dy = poses_[i][k][kPoseY] - ego[1];
+        double d2 = dx * dx + dy * dy;
+        if (!(d2 <= range2)) return;
+        /* insertion into the sorted list of the nearest ones */
+        int j = found < kObstacleSlots ? found++ : kObstacleSlots;
+        while (j > 0 && distance2[j - 1] > d2) {
+            if (j < kObstacleSlots) {
+                nearest[j] = nearest[j - 1];
+                distance2[j] = distance2[j - 1];
+            }
+            j--;
+        }
+        if (j < kObstacleSlots) {
+            nearest[j] = i;
+            distance2[j] = d2;
+        }
+    };
+
+    const int w = k / kWindow;
+    const int x0 = cell(ego[0] - config_.range), x1 = cell(ego[0] + config_.range);
+    const int y0 = cell(ego[1] - config_.range), y1 = cell(ego[1] + config_.range);
+    for (int ix = x0; ix <= x1; ix++) {
+        for (int iy = y0; iy <= y1; iy++) {
+            int b = bucket(ix, iy);
+            for (int e = start_[w][b]; e < start_[w][b + 1]; e++) consider(entries_[w][e]);
+        }
+    }
+    for (int e = 0; e < wide_count_[w]; e++) consider(wide_[w][e]);
+
+    /* keep the slot of the previous stage so the constraints do not swap */
+    int* active = active_[k];
+    std::fill(active, active + kObstacleSlots, -1);
+    bool placed[kObstacleSlots] = {};
+    if (k > 0) {
+        for (int s = 0; s < kObstacleSlots; s++) {
+            for (int j = 0; j < found; j++) {
+                if (!placed[j] && nearest[j] == active_[k - 1][s]) {
+                    active[s] = nearest[j];
+                    placed[j] = true;
+                }
+            }
+        }
+    }
+    for (int j = 0, s = 0; j < found; j++) {
+        if (placed[j]) continue;
+        while (active[s] != -1) s++;
+        active[s] = nearest[j];
+    }
+}
+
+void ObstacleManager::write_parameters(const double ego_xy[kStages][2], double* all_parameters,
+                                       double mass, double inertia)
+{
+    candidates_ = 0;
+    for (int k = 0; k < kStages; k++) {
+        select(k, ego_xy[k]);
+
+        double* params = ego_stage_params(all_parameters, k);
+        reset_ego_stage_params(params, mass, inertia);
+        for (int s = 0; s < kObstacleSlots; s++) {
+            if (active_[k][s] < 0) continue;
+            const double* pose = poses_[active_[k][s]][k];
+            std::copy(pose, pose + kPoseParams, obstacle_pose(params, s));
+        }
+    }
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,58 @@
+#include "mpc_planner/obstacle_predictor.h"
+
+#include <algorithm>
+
+#include "mpc_planner/vehicle_model.h"
+
+namespace mpc_planner {
+
+void reset_ego_stage_params(double stage_params[kEgoStageParams], double mass, double inertia)
+{
+    stage_params[kParamMass] = mass;
+    stage_params[kParamInertia] = inertia;
+    for (int slot = 0; slot < kObstacleSlots; slot++) {
+        double* pose = obstacle_pose(stage_params, slot);
+        pose[kPoseX] = kParkedPosition;
+        pose[kPoseY] = kParkedPosition;
+        pose[kPoseTheta] = 0;
+    }
+}
+
+void predict_obstacle(const double x[kCarStates], int slot, double step, double* all_parameters)
+{
+    const double u[kCarInputs] = { 0, 0 };
+    double state[kCarStates], next[kCarStates];
+    std::copy(x, x + kCarStates, state);
+
+    for (int k = 0; k < kStages; k++) {
+        double* pose = obstacle_pose(ego_stage_params(all_parameters, k), slot);
+        pose[kPoseX] = state[kX];
+        pose[kPoseY] = state[kY];
+        pose[kPoseTheta] = state[kTheta];
+
+        car_rk4(state, u, 1, 1, step, next);
+        std::copy(next, next + kCarStates, state);
+    }
+}
+
+void predict_obstacles(const ObstacleSet& set, double stamp, double step, double* all_parameters,
+                       double mass, double inertia)
+{
+    const double u[kCarInputs] = { 0, 0 };
+    const double dt = std::max(0.0, stamp - set.stamp);
+
+    for (int k = 0; k < kStages; k++) {
+        reset_ego_stage_params(ego_stage_params(all_parameters, k), mass, inertia);
+    }
+    for (int i = 0; i < std::min(set.count, kObstacleSlots); i++) {
+        double x[kCarStates];
+        if (dt > 0) {
+            car_rk4(set.obstacles[i].x, u, 1, 1, dt, x);
+        } else {
+            std::copy(set.obstacles[i].x, set.obstacles[i].x + kCarStates, x);
+        }
+        predict_obstacle(x, i, step, all_parameters);
+    }
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,99 @@
+#include "mpc_planner/perf_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace mpc_planner {
+
+#ifdef __linux__
+
+static int open_event(std::uint32_t type, std::uint64_t config, int group)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group < 0;  /* the leader starts the group */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+bool PerfCounters::open()
+{
+    static const struct {
+        std::uint32_t type;
+        std::uint64_t config;
+    } events[kPerfEvents] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    close();
+    for (int i = 0; i < kPerfEvents; i++) {
+        fd_[i] = open_event(events[i].type, events[i].config, leader_);
+        if (fd_[i] < 0) continue;
+        if (leader_ < 0) leader_ = fd_[i];
+        slot_[i] = opened_++;
+    }
+    if (leader_ < 0) return false;
+
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void PerfCounters::close()
+{
+    for (int i = 0; i < kPerfEvents; i++) {
+        if (fd_[i] >= 0) ::close(fd_[i]);
+        fd_[i] = -1;
+        slot_[i] = -1;
+    }
+    leader_ = -1;
+    opened_ = 0;
+}
+
+CounterValues PerfCounters::read() const
+{
+    CounterValues counts;
+    if (leader_ < 0) return counts;
+
+    /* nr, time_enabled, time_running, value[nr] */
+    std::uint64_t data[3 + kPerfEvents];
+    if (::read(leader_, data, sizeof(data)) < static_cast<ssize_t>(sizeof(std::uint64_t) * (3 + opened_))) {
+        return counts;
+    }
+    const double scale = data[2] > 0 && data[2] < data[1] ? static_cast<double>(data[1]) / data[2] : 1;
+    for (int i = 0; i < kPerfEvents; i++) {
+        if (slot_[i] >= 0) counts.value[i] = static_cast<std::uint64_t>(scale * data[3 + slot_[i]]);
+    }
+    return counts;
+}
+
+#else
+
+bool PerfCounters::open() { return false; }
+void PerfCounters::close() {}
+CounterValues PerfCounters::read() const { return CounterValues(); }
+
+#endif
+
+const char* PerfCounters::name(PerfEvent event)
+{
+    static const char* names[kPerfEvents] = { "cycles", "instructions", "llc_misses", "branch_misses" };
+    return names[event];
+}
+
+}  /* namespace mpc_planner */
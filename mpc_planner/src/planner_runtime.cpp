@@ -0,0 +1,197 @@
+#include "mpc_planner/planner_runtime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "mpc_planner/emergency_stop.h"
+
+namespace mpc_planner {
+
+using Clock = std::chrono::steady_clock;
+
+static Clock::duration to_duration(double seconds)
+{
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+double PlannerRuntime::now()
+{
+    return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+PlannerRuntime::PlannerRuntime(const PlannerConfig& config) : config_(config) {}
+
+PlannerRuntime::~PlannerRuntime()
+{
+    stop();
+}
+
+bool PlannerRuntime::start()
+{
+    if (running_.exchange(true)) return false;
+    if (config_.solve_deadline > 0) solver_.set_ext_func(FORCESNLPsolver_casadi2forces_deadline);
+    if (config_.multi_start_workers > 0 && !multi_start_) {
+        MultiStartConfig multi_start;
+        multi_start.workers = config_.multi_start_workers;
+        multi_start.deadline = config_.solve_deadline;
+        multi_start_.reset(new MultiStartSolver(multi_start));
+        if (!multi_start_->ok()) {
+            multi_start_.reset();
+            running_ = false;
+            return false;
+        }
+    }
+    if (!config_.record_path.empty() && !recorder_) {
+        SolveRecorderConfig record;
+        record.path = config_.record_path;
+        recorder_.reset(new SolveRecorder(record));
+        if (!recorder_->ok()) {
+            recorder_.reset();
+            running_ = false;
+            return false;
+        }
+    }
+    solver_thread_ = std::thread(&PlannerRuntime::solver_loop, this);
+    control_thread_ = std::thread(&PlannerRuntime::control_loop, this);
+    return true;
+}
+
+void PlannerRuntime::stop()
+{
+    running_ = false;
+    if (solver_thread_.joinable()) solver_thread_.join();
+    if (control_thread_.joinable()) control_thread_.join();
+}
+
+void PlannerRuntime::solver_loop()
+{
+    const Clock::duration period = to_duration(config_.replan_period);
+    Clock::time_point next = Clock::now();
+    bool have_state = false;
+    double last_stamp = 0;
+    double xinit[kStates];
+    ObstacleSlots obstacle_slots;
+
+    /* multi-start: shifted previous plan, braking, lane keeping, box midpoint */
+    static constexpr int kGuesses = 4;
+    std::unique_ptr<double[]> guess_storage(new double[kGuesses * kGuessSize]);
+    const double* guesses[kGuesses];
+    for (int i = 0; i < kGuesses; i++) guesses[i] = guess_storage.get() + i * kGuessSize;
+    std::unique_ptr<Trajectory> previous(new Trajectory);
+    bool have_previous = false;
+    std::unique_ptr<Trajectory> fallback(new Trajectory);
+    bool have_fallback = false;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        if (states_.update()) have_state = true;
+
+        if (have_state) {
+            const StateEstimate& state = states_.front();
+
+            /* warm start from the previous plan, advanced by the time that has passed */
+            int shift = last_stamp > 0 ? static_cast<int>(std::lround((state.stamp - last_stamp) / kStepSize)) : 0;
+            solver_.warm_start(shift);
+
+            std::copy(state.x, state.x + kStates, xinit);
+            write_obstacle_states(obstacles_.snapshot(), state.stamp, &obstacle_slots, xinit);
+
+            Trajectory& out = trajectories_.back();
+            int exitflag;
+            if (multi_start_) {
+                double* storage = guess_storage.get();
+                if (have_previous) {
+                    guess_shifted(*previous, shift, storage);
+                } else {
+                    guess_midpoint(storage);
+                }
+                guess_braking(xinit, storage + kGuessSize);
+                guess_lane_keep(xinit, storage + 2 * kGuessSize);
+                guess_midpoint(storage + 3 * kGuessSize);
+                int winner = -1;
+                exitflag = multi_start_->solve(xinit, guesses, kGuesses, &out, &winner);
+                if (recorder_ && winner >= 0) {
+                    recorder_->record(state.stamp, config_.solve_deadline, winner, multi_start_->params(winner),
+                                      multi_start_->output(winner), exitflag, multi_start_->info(winner));
+                }
+            } else {
+                if (config_.solve_deadline > 0) FORCESNLPsolver_set_deadline(config_.solve_deadline);
+                exitflag = solver_.solve(xinit, &out);
+                if (recorder_) {
+                    recorder_->record(state.stamp, config_.solve_deadline, -1, solver_.params(), solver_.output(),
+                                      exitflag, solver_.info());
+                }
+            }
+            out.stamp = state.stamp;
+            if (exitflag == FORCESNLPsolver_OPTIMAL) {
+                trajectory_service_.publish(out, solver_.params().all_parameters[0], solver_.params().all_parameters[1]);
+                if (multi_start_) {
+                    *previous = out;
+                    have_previous = true;
+                }
+                /* ready for the next replan, from the state the plan expects by then */
+                emergency_stop(out.states(1), out.stamp + out.time[1], fallback.get());
+                have_fallback = true;
+            } else {
+                /* keep braking along the prepared stop; without one, stop from here */
+                if (!have_fallback) {
+                    emergency_stop(xinit, state.stamp, fallback.get());
+                    have_fallback = true;
+                }
+                out = *fallback;
+                out.exitflag = exitflag;
+                stats_.fallbacks++;
+            }
+            trajectories_.publish();
+
+            last_stamp = state.stamp;
+            stats_.solves++;
+            if (exitflag != FORCESNLPsolver_OPTIMAL) stats_.failures++;
+        }
+
+        next += period;
+        Clock::time_point t = Clock::now();
+        if (next < t) {
+            /* the solve took longer than a period: replan right away */
+            stats_.solver_overruns++;
+            next = t;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void PlannerRuntime::control_loop()
+{
+    const Clock::duration period = to_duration(config_.control_period);
+    Clock::time_point next = Clock::now();
+    bool have_trajectory = false;
+    ControlCommand command;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        if (trajectories_.update()) have_trajectory = true;
+
+        command.stamp = now();
+        command.valid = false;
+        if (have_trajectory) {
+            const Trajectory& trajectory = trajectories_.front();
+            /* zero-order hold of the stage the current time falls into */
+            int k = trajectory.stage_at(command.stamp - trajectory.stamp);
+            command.stage = k;
+            command.u[kForce] = trajectory.inputs(k)[kForce];
+            command.u[kSteer] = trajectory.inputs(k)[kSteer];
+            command.valid = trajectory.exitflag == FORCESNLPsolver_OPTIMAL || trajectory.fallback;
+        }
+        if (callback_) callback_(command, trajectories_.front());
+        stats_.control_ticks++;
+
+        next += period;
+        Clock::time_point t = Clock::now();
+        if (next < t) {
+            stats_.control_overruns++;
+            next = t;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+}  /* namespace mpc_planner */
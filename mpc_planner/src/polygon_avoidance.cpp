@@ -0,0 +1,153 @@
+#include "mpc_planner/polygon_avoidance.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mpc_planner {
+
+namespace {
+
+/* local variables of the rows of one obstacle: x y theta lambda mu */
+enum { kLocalX = 0, kLocalY, kLocalTheta, kLocalLambda, kLocalMu = kLocalLambda + kObcaLambdas, kLocals = kLocalMu + kObcaMus };
+
+/* face K of A = [N; -N]: its sign and row of N */
+constexpr double kFaceSign[kObcaLambdas] = { 1, 1, -1, -1 };
+constexpr int kFaceAxis[kObcaLambdas] = { 0, 1, 0, 1 };
+
+/*
+ * The rows of one obstacle at the ego pose EGO and obstacle pose OBSTACLE and
+ * their Jacobian J w.r.t. the local variables, unless nullptr.
+ */
+void obca_rows(const double ego[kPoseParams], const Footprint& ego_footprint, const double obstacle[kPoseParams],
+               const Footprint& obstacle_footprint, const double lambda[kObcaLambdas], const double mu[kObcaMus],
+               double rows[kObcaRows], double J[kObcaRows][kLocals])
+{
+    const double L = ego_footprint.half_length, W = ego_footprint.half_width;
+    const double extent[2] = { obstacle_footprint.half_length, obstacle_footprint.half_width };
+
+    /* normals of the obstacle (rows of N) and axes of the ego car */
+    const double co = std::cos(obstacle[kPoseTheta]), so = std::sin(obstacle[kPoseTheta]);
+    const double n[2][2] = { { co, so }, { -so, co } };
+    const double c = std::cos(ego[kPoseTheta]), s = std::sin(ego[kPoseTheta]);
+    const double dp[2] = { ego[kPoseX] - obstacle[kPoseX], ego[kPoseY] - obstacle[kPoseY] };
+
+    /* w = A' lambda, v = -R' w */
+    double w[2] = { 0, 0 }, offset = 0;
+    for (int k = 0; k < kObcaLambdas; k++) {
+        w[0] += kFaceSign[k] * lambda[k] * n[kFaceAxis[k]][0];
+        w[1] += kFaceSign[k] * lambda[k] * n[kFaceAxis[k]][1];
+        offset += extent[kFaceAxis[k]] * lambda[k];
+    }
+    const double vx = -(c * w[0] + s * w[1]);
+    const double vy = s * w[0] - c * w[1];
+
+    rows[kObcaSeparation] = w[0] * dp[0] + w[1] * dp[1] - offset - L * (2 * mu[0] - vx) - W * (2 * mu[1] - vy);
+    rows[kObcaDualNorm] = w[0] * w[0] + w[1] * w[1];
+    rows[kObcaBalanceX] = mu[0] - vx;
+    rows[kObcaBalanceY] = mu[1] - vy;
+    if (!J) return;
+
+    std::fill(&J[0][0], &J[0][0] + kObcaRows * kLocals, 0.0);
+    J[kObcaSeparation][kLocalX] = w[0];
+    J[kObcaSeparation][kLocalY] = w[1];
+    J[kObcaSeparation][kLocalTheta] = L * vy - W * vx;
+    J[kObcaBalanceX][kLocalTheta] = -vy;
+    J[kObcaBalanceY][kLocalTheta] = vx;
+    for (int k = 0; k < kObcaLambdas; k++) {
+        const double gx = kFaceSign[k] * n[kFaceAxis[k]][0], gy = kFaceSign[k] * n[kFaceAxis[k]][1];
+        const double dvx = -(c * gx + s * gy), dvy = s * gx - c * gy;
+        J[kObcaSeparation][kLocalLambda + k] = gx * dp[0] + gy * dp[1] - extent[kFaceAxis[k]] + L * dvx + W * dvy;
+        J[kObcaDualNorm][kLocalLambda + k] = 2 * (w[0] * gx + w[1] * gy);
+        J[kObcaBalanceX][kLocalLambda + k] = -dvx;
+        J[kObcaBalanceY][kLocalLambda + k] = -dvy;
+    }
+    J[kObcaSeparation][kLocalMu] = -2 * L;
+    J[kObcaSeparation][kLocalMu + 1] = -2 * W;
+    J[kObcaBalanceX][kLocalMu] = 1;
+    J[kObcaBalanceY][kLocalMu + 1] = 1;
+}
+
+}  /* namespace */
+
+double separating_duals(const double ego[kPoseParams], const Footprint& ego_footprint,
+                        const double obstacle[kPoseParams], const Footprint& obstacle_footprint,
+                        double lambda[kObcaLambdas], double mu[kObcaMus])
+{
+    const double co = std::cos(obstacle[kPoseTheta]), so = std::sin(obstacle[kPoseTheta]);
+    const double c = std::cos(ego[kPoseTheta]), s = std::sin(ego[kPoseTheta]);
+    const double ego_axes[2][2] = { { c, s }, { -s, c } };
+
+    /* candidates: the faces of the obstacle, then those of the ego car */
+    double best = -kInf;
+    for (int face = 0; face < 2 * kObcaLambdas; face++) {
+        double w[2];
+        if (face < kObcaLambdas) {
+            /* lambda on one face of the obstacle, w its outward normal */
+            const double nx = kFaceAxis[face] ? -so : co, ny = kFaceAxis[face] ? co : so;
+            w[0] = kFaceSign[face] * nx;
+            w[1] = kFaceSign[face] * ny;
+        } else {
+            /* mu on one face of the ego car, w against its outward normal */
+            const int k = face - kObcaLambdas;
+            w[0] = -kFaceSign[k] * ego_axes[kFaceAxis[k]][0];
+            w[1] = -kFaceSign[k] * ego_axes[kFaceAxis[k]][1];
+        }
+
+        /* lambda with A' lambda = w, mu+ = max(-R' w, 0) */
+        double l[kObcaLambdas], m[kObcaMus];
+        const double a0 = co * w[0] + so * w[1], a1 = -so * w[0] + co * w[1];
+        l[0] = std::max(a0, 0.0);
+        l[1] = std::max(a1, 0.0);
+        l[2] = std::max(-a0, 0.0);
+        l[3] = std::max(-a1, 0.0);
+        m[0] = std::max(-(c * w[0] + s * w[1]), 0.0);
+        m[1] = std::max(s * w[0] - c * w[1], 0.0);
+
+        double rows[kObcaRows];
+        obca_rows(ego, ego_footprint, obstacle, obstacle_footprint, l, m, rows, nullptr);
+        if (rows[kObcaSeparation] > best) {
+            best = rows[kObcaSeparation];
+            std::copy(l, l + kObcaLambdas, lambda);
+            std::copy(m, m + kObcaMus, mu);
+        }
+    }
+    return best;
+}
+
+void obca_constraints(const double z[kObcaStageVars], const double* p, double h[kObcaIneqs], double* nabla_h)
+{
+    const double ego[kPoseParams] = { z[kCarInputs + kX], z[kCarInputs + kY], z[kCarInputs + kTheta] };
+    const int columns[kLocalLambda] = { kCarInputs + kX, kCarInputs + kY, kCarInputs + kTheta };
+    for (int slot = 0; slot < kObstacleSlots; slot++) {
+        const double* obstacle = p + kParamObstacles + kPoseParams * slot;
+        const double* duals = z + obca_duals(slot);
+        double rows[kObcaRows], J[kObcaRows][kLocals];
+        obca_rows(ego, kEgoFootprint, obstacle, kObstacleFootprint, duals, duals + kObcaLambdas, rows,
+                  nabla_h ? J : nullptr);
+        const int first = kObcaRows * slot;
+        if (h) std::copy(rows, rows + kObcaRows, h + first);
+        if (!nabla_h) continue;
+        for (int r = 0; r < kObcaRows; r++) {
+            for (int j = 0; j < kLocals; j++) {
+                const int column = j < kLocalLambda ? columns[j] : obca_duals(slot) + j - kLocalLambda;
+                nabla_h[column * kObcaIneqs + first + r] = J[r][j];
+            }
+        }
+    }
+}
+
+void warm_start_duals(double* x0, const double* all_parameters)
+{
+    for (int k = 0; k < kStages; k++) {
+        double* z = x0 + kObcaStageVars * k;
+        const double* p = all_parameters + kEgoStageParams * k;
+        const double ego[kPoseParams] = { z[kCarInputs + kX], z[kCarInputs + kY], z[kCarInputs + kTheta] };
+        for (int slot = 0; slot < kObstacleSlots; slot++) {
+            double* duals = z + obca_duals(slot);
+            separating_duals(ego, kEgoFootprint, p + kParamObstacles + kPoseParams * slot, kObstacleFootprint,
+                             duals, duals + kObcaLambdas);
+        }
+    }
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,426 @@
+#include "mpc_planner/reference_path.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mpc_planner {
+
+namespace {
+
+constexpr int kArcSubintervals = 8;      /* Gauss-Legendre panels per spline segment */
+constexpr int kArcNewtonSteps = 3;
+constexpr int kProjectionSteps = 5;
+constexpr int kTileCells = 16;           /* grid cells per tile edge */
+constexpr int kTileSize = kTileCells * kTileCells;
+
+std::uint64_t hash_tile(std::int64_t key)
+{
+    return static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+}
+
+/* one coordinate of a spline segment, y(t) = a + b t + c t^2 + d t^3 for t in [0, h] */
+struct Cubic {
+    double a, b, c, d;
+
+    double value(double t) const { return a + t * (b + t * (c + t * d)); }
+    double slope(double t) const { return b + t * (2 * c + 3 * t * d); }
+    double curve(double t) const { return 2 * c + 6 * t * d; }
+};
+
+/*
+ * Solves the tridiagonal system with sub-diagonal A, diagonal B and
+ * super-diagonal C for R, in place; B is overwritten.
+ */
+void solve_tridiagonal(const std::vector<double>& a, std::vector<double>& b, const std::vector<double>& c,
+                       std::vector<double>& r, int n)
+{
+    for (int i = 1; i < n; i++) {
+        double w = a[i] / b[i - 1];
+        b[i] -= w * c[i - 1];
+        r[i] -= w * r[i - 1];
+    }
+    r[n - 1] /= b[n - 1];
+    for (int i = n - 2; i >= 0; i--) r[i] = (r[i] - c[i] * r[i + 1]) / b[i];
+}
+
+/*
+ * Second derivatives M of the cubic spline through Y at the knot spacings H:
+ * natural ends, or periodic (H[n-1] closing the last knot to the first).
+ */
+void spline_curvatures(const std::vector<double>& y, const std::vector<double>& h, bool closed,
+                       std::vector<double>& m)
+{
+    const int n = static_cast<int>(y.size());
+    m.assign(n, 0.0);
+    if (!closed && n < 3) return;
+
+    /* row i: h[i-1] M[i-1] + 2 (h[i-1] + h[i]) M[i] + h[i] M[i+1] = 6 (slope_i - slope_(i-1)) */
+    auto slope = [&](int i) { return (y[(i + 1) % n] - y[i]) / h[i]; };
+    if (!closed) {
+        const int k = n - 2;
+        std::vector<double> a(k), b(k), c(k), r(k);
+        for (int j = 0; j < k; j++) {
+            int i = j + 1;
+            a[j] = h[i - 1];
+            b[j] = 2 * (h[i - 1] + h[i]);
+            c[j] = h[i];
+            r[j] = 6 * (slope(i) - slope(i - 1));
+        }
+        solve_tridiagonal(a, b, c, r, k);
+        for (int j = 0; j < k; j++) m[j + 1] = r[j];
+        return;
+    }
+
+    /* cyclic system by Sherman-Morrison: corners alpha = A[n-1][0], beta = A[0][n-1] */
+    std::vector<double> a(n), b(n), c(n), r(n), u(n, 0.0);
+    for (int i = 0; i < n; i++) {
+        int prev = (i + n - 1) % n;
+        a[i] = h[prev];
+        b[i] = 2 * (h[prev] + h[i]);
+        c[i] = h[i];
+        r[i] = 6 * (slope(i) - slope(prev));
+    }
+    const double alpha = c[n - 1], beta = a[0];
+    const double gamma = -b[0];
+    b[0] -= gamma;
+    b[n - 1] -= alpha * beta / gamma;
+    std::vector<double> bb = b;
+    solve_tridiagonal(a, b, c, r, n);
+    u[0] = gamma;
+    u[n - 1] = alpha;
+    solve_tridiagonal(a, bb, c, u, n);
+    const double fact = (r[0] + beta * r[n - 1] / gamma) / (1 + u[0] + beta * u[n - 1] / gamma);
+    for (int i = 0; i < n; i++) m[i] = r[i] - fact * u[i];
+}
+
+/* arc length of a segment from 0 to T, 3-point Gauss-Legendre */
+double arc(const Cubic& x, const Cubic& y, double t0, double t1)
+{
+    static const double node = std::sqrt(0.6);
+    const double mid = (t0 + t1) / 2, half = (t1 - t0) / 2;
+    double sum = 0;
+    const double nodes[3] = { mid - half * node, mid, mid + half * node };
+    const double weights[3] = { 5.0 / 9, 8.0 / 9, 5.0 / 9 };
+    for (int q = 0; q < 3; q++) sum += weights[q] * std::hypot(x.slope(nodes[q]), y.slope(nodes[q]));
+    return half * sum;
+}
+
+}  /* namespace */
+
+bool ReferencePath::build(const ReferencePathConfig& config, const double* x, const double* y, int n)
+{
+    samples_.clear();
+    tiles_.clear();
+    grid_.clear();
+    length_ = 0;
+    config_ = config;
+    if (n < (config.closed ? 3 : 2) || config.sample_spacing <= 0 || config.cell_size <= 0) return false;
+
+    /* chord length parametrization */
+    const int spline_segments = config.closed ? n : n - 1;
+    std::vector<double> h(n, 0.0);
+    for (int i = 0; i < spline_segments; i++) {
+        int j = (i + 1) % n;
+        h[i] = std::hypot(x[j] - x[i], y[j] - y[i]);
+        if (h[i] <= 0) return false;
+    }
+    std::vector<double> mx, my;
+    spline_curvatures(std::vector<double>(x, x + n), h, config.closed, mx);
+    spline_curvatures(std::vector<double>(y, y + n), h, config.closed, my);
+
+    std::vector<Cubic> cx(spline_segments), cy(spline_segments);
+    for (int i = 0; i < spline_segments; i++) {
+        int j = (i + 1) % n;
+        cx[i] = { x[i], (x[j] - x[i]) / h[i] - h[i] * (2 * mx[i] + mx[j]) / 6, mx[i] / 2, (mx[j] - mx[i]) / (6 * h[i]) };
+        cy[i] = { y[i], (y[j] - y[i]) / h[i] - h[i] * (2 * my[i] + my[j]) / 6, my[i] / 2, (my[j] - my[i]) / (6 * h[i]) };
+    }
+
+    /* cumulative arc length at the panel boundaries */
+    std::vector<double> table(spline_segments * kArcSubintervals + 1, 0.0);
+    for (int i = 0; i < spline_segments; i++) {
+        for (int q = 0; q < kArcSubintervals; q++) {
+            int k = i * kArcSubintervals + q;
+            double dt = h[i] / kArcSubintervals;
+            table[k + 1] = table[k] + arc(cx[i], cy[i], q * dt, (q + 1) * dt);
+        }
+    }
+    length_ = table.back();
+
+    /* uniform resampling in arc length */
+    segments_ = std::max(1, static_cast<int>(std::ceil(length_ / config.sample_spacing)));
+    spacing_ = length_ / segments_;
+    const int count = config.closed ? segments_ : segments_ + 1;
+    samples_.resize(count);
+    int panel = 0;
+    for (int k = 0; k < count; k++) {
+        const double target = std::min(k * spacing_, length_);
+        const int panels = static_cast<int>(table.size()) - 1;
+        while (panel < panels - 1 && table[panel + 1] < target) panel++;
+        const int i = panel / kArcSubintervals;
+        const double dt = h[i] / kArcSubintervals;
+        const double t0 = (panel % kArcSubintervals) * dt;
+        const double width = table[panel + 1] - table[panel];
+        double t = t0 + (width > 0 ? (target - table[panel]) / width : 0) * dt;
+        for (int it = 0; it < kArcNewtonSteps; it++) {
+            double speed = std::hypot(cx[i].slope(t), cy[i].slope(t));
+            if (speed <= 0) break;
+            t -= (table[panel] + arc(cx[i], cy[i], t0, t) - target) / speed;
+        }
+        const double dx = cx[i].slope(t), dy = cy[i].slope(t);
+        const double speed = std::hypot(dx, dy);
+        Sample& sample = samples_[k];
+        sample.x = cx[i].value(t);
+        sample.y = cy[i].value(t);
+        sample.tx = dx / speed;
+        sample.ty = dy / speed;
+        sample.kappa = (dx * cy[i].curve(t) - dy * cx[i].curve(t)) / (speed * speed * speed);
+    }
+
+    /* nearest sample of each cell centre within the margin, on the tiles the margin reaches */
+    double x0 = samples_[0].x, x1 = x0, y0 = samples_[0].y, y1 = y0;
+    for (const Sample& s : samples_) {
+        x0 = std::min(x0, s.x);
+        x1 = std::max(x1, s.x);
+        y0 = std::min(y0, s.y);
+        y1 = std::max(y1, s.y);
+    }
+    const double cell = config.cell_size, margin = config.margin;
+    const double nx = std::ceil((x1 - x0 + 2 * margin) / cell) + 1, ny = std::ceil((y1 - y0 + 2 * margin) / cell) + 1;
+    if (!(nx < 1 << 30 && ny < 1 << 30)) {
+        samples_.clear();
+        return false;
+    }
+    grid_x_ = x0 - margin;
+    grid_y_ = y0 - margin;
+    grid_nx_ = static_cast<int>(nx);
+    grid_ny_ = static_cast<int>(ny);
+    tiles_nx_ = (grid_nx_ + kTileCells - 1) / kTileCells;
+
+    /* cell ranges of the samples' margins, and the tiles they touch */
+    struct Range {
+        int i0, i1, j0, j1;
+    };
+    std::vector<Range> ranges(count);
+    std::vector<std::int64_t> keys;
+    for (int k = 0; k < count; k++) {
+        const Sample& s = samples_[k];
+        Range& r = ranges[k];
+        r.i0 = std::max(0, static_cast<int>((s.x - margin - grid_x_) / cell));
+        r.i1 = std::min(grid_nx_ - 1, static_cast<int>((s.x + margin - grid_x_) / cell));
+        r.j0 = std::max(0, static_cast<int>((s.y - margin - grid_y_) / cell));
+        r.j1 = std::min(grid_ny_ - 1, static_cast<int>((s.y + margin - grid_y_) / cell));
+        for (int tj = r.j0 / kTileCells; tj <= r.j1 / kTileCells; tj++) {
+            for (int ti = r.i0 / kTileCells; ti <= r.i1 / kTileCells; ti++) {
+                keys.push_back(static_cast<std::int64_t>(tj) * tiles_nx_ + ti);
+            }
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    if (static_cast<double>(keys.size()) * kTileSize > config.max_grid_cells) {
+        samples_.clear();
+        return false;
+    }
+
+    size_t slots = 1;
+    while (slots < 2 * keys.size()) slots *= 2;
+    tiles_.assign(slots, Tile{ -1, -1 });
+    for (size_t t = 0; t < keys.size(); t++) {
+        size_t slot = hash_tile(keys[t]) & (slots - 1);
+        while (tiles_[slot].key >= 0) slot = (slot + 1) & (slots - 1);
+        tiles_[slot] = { keys[t], static_cast<std::int32_t>(t * kTileSize) };
+    }
+    grid_.assign(keys.size() * kTileSize, -1);
+    std::vector<float> distance(grid_.size(), std::numeric_limits<float>::infinity());
+
+    for (int k = 0; k < count; k++) {
+        const Sample& s = samples_[k];
+        const Range& r = ranges[k];
+        for (int tj = r.j0 / kTileCells; tj <= r.j1 / kTileCells; tj++) {
+            for (int ti = r.i0 / kTileCells; ti <= r.i1 / kTileCells; ti++) {
+                const std::int32_t first = tile(static_cast<std::int64_t>(tj) * tiles_nx_ + ti).first;
+                const int j1 = std::min(r.j1, tj * kTileCells + kTileCells - 1);
+                const int i1 = std::min(r.i1, ti * kTileCells + kTileCells - 1);
+                for (int j = std::max(r.j0, tj * kTileCells); j <= j1; j++) {
+                    for (int i = std::max(r.i0, ti * kTileCells); i <= i1; i++) {
+                        double ex = grid_x_ + (i + 0.5) * cell - s.x;
+                        double ey = grid_y_ + (j + 0.5) * cell - s.y;
+                        float e = static_cast<float>(ex * ex + ey * ey);
+                        size_t c = first + (j % kTileCells) * kTileCells + i % kTileCells;
+                        if (e <= margin * margin && e < distance[c]) {
+                            distance[c] = e;
+                            grid_[c] = k;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+double ReferencePath::wrap(double s) const
+{
+    if (config_.closed) {
+        s = std::fmod(s, length_);
+        return s < 0 ? s + length_ : s;
+    }
+    return std::min(std::max(s, 0.0), length_);
+}
+
+int ReferencePath::locate(double s, double* tau) const
+{
+    double u = wrap(s) / spacing_;
+    int i = std::min(static_cast<int>(u), segments_ - 1);
+    *tau = u - i;
+    return i;
+}
+
+void ReferencePath::evaluate(double s, double c[2], double dc[2], double ddc[2]) const
+{
+    double t;
+    const int i = locate(s, &t);
+    const Sample& a = samples_[i];
+    const Sample& b = samples_[(i + 1) % samples_.size()];
+    const double h = spacing_;
+
+    /* cubic Hermite between the samples, exact positions and unit tangents */
+    const double t2 = t * t, t3 = t2 * t;
+    const double h00 = 2 * t3 - 3 * t2 + 1, h10 = t3 - 2 * t2 + t, h01 = -2 * t3 + 3 * t2, h11 = t3 - t2;
+    const double d00 = 6 * t2 - 6 * t, d10 = 3 * t2 - 4 * t + 1, d01 = -d00, d11 = 3 * t2 - 2 * t;
+    const double e00 = 12 * t - 6, e10 = 6 * t - 4, e01 = -e00, e11 = 6 * t - 2;
+    c[0] = h00 * a.x + h10 * h * a.tx + h01 * b.x + h11 * h * b.tx;
+    c[1] = h00 * a.y + h10 * h * a.ty + h01 * b.y + h11 * h * b.ty;
+    dc[0] = (d00 * a.x + d10 * h * a.tx + d01 * b.x + d11 * h * b.tx) / h;
+    dc[1] = (d00 * a.y + d10 * h * a.ty + d01 * b.y + d11 * h * b.ty) / h;
+    ddc[0] = (e00 * a.x + e10 * h * a.tx + e01 * b.x + e11 * h * b.tx) / (h * h);
+    ddc[1] = (e00 * a.y + e10 * h * a.ty + e01 * b.y + e11 * h * b.ty) / (h * h);
+}
+
+PathPoint ReferencePath::point(double s) const
+{
+    PathPoint p;
+    double c[2], dc[2], ddc[2], t;
+    p.s = wrap(s);
+    evaluate(p.s, c, dc, ddc);
+    const int i = locate(p.s, &t);
+    p.x = c[0];
+    p.y = c[1];
+    p.theta = std::atan2(dc[1], dc[0]);
+    p.kappa = (1 - t) * samples_[i].kappa + t * samples_[(i + 1) % samples_.size()].kappa;
+    return p;
+}
+
+const ReferencePath::Tile& ReferencePath::tile(std::int64_t key) const
+{
+    const size_t mask = tiles_.size() - 1;
+    size_t slot = hash_tile(key) & mask;
+    while (tiles_[slot].key >= 0 && tiles_[slot].key != key) slot = (slot + 1) & mask;
+    return tiles_[slot];
+}
+
+int ReferencePath::nearest_sample(double x, double y) const
+{
+    /* compared as doubles, so positions far off the grid never overflow the cast */
+    const double u = (x - grid_x_) / config_.cell_size, v = (y - grid_y_) / config_.cell_size;
+    if (!(u >= 0 && v >= 0 && u < grid_nx_ && v < grid_ny_)) return -1;
+    const int i = static_cast<int>(u), j = static_cast<int>(v);
+    const Tile& t = tile(static_cast<std::int64_t>(j / kTileCells) * tiles_nx_ + i / kTileCells);
+    if (t.first < 0) return -1;
+    return grid_[t.first + (j % kTileCells) * kTileCells + i % kTileCells];
+}
+
+bool ReferencePath::project(double x, double y, FrenetPoint* f) const
+{
+    int k = nearest_sample(x, y);
+    const bool covered = k >= 0;
+    if (!covered) {
+        double best = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < static_cast<int>(samples_.size()); i++) {
+            double e = std::hypot(x - samples_[i].x, y - samples_[i].y);
+            if (e < best) {
+                best = e;
+                k = i;
+            }
+        }
+    }
+
+    /* Newton on (p - c(s)) . c'(s) = 0, kept within a sample spacing per step */
+    double s = k * spacing_;
+    double c[2], dc[2], ddc[2];
+    for (int it = 0; it < kProjectionSteps; it++) {
+        evaluate(s, c, dc, ddc);
+        const double rx = x - c[0], ry = y - c[1];
+        const double g = rx * dc[0] + ry * dc[1];
+        const double slope = dc[0] * dc[0] + dc[1] * dc[1] - (rx * ddc[0] + ry * ddc[1]);
+        double step = slope > 0 ? g / slope : g;
+        step = std::min(std::max(step, -spacing_), spacing_);
+        double next = wrap(s + step);
+        if (next == s) break;
+        s = next;
+    }
+
+    evaluate(s, c, dc, ddc);
+    const double norm = std::hypot(dc[0], dc[1]);
+    const double tx = dc[0] / norm, ty = dc[1] / norm;
+    const double rx = x - c[0], ry = y - c[1];
+    const double along = rx * tx + ry * ty;
+    f->s = s;
+    f->d = -rx * ty + ry * tx;
+    f->dd[0] = -ty;
+    f->dd[1] = tx;
+    if (!config_.closed && ((s <= 0 && along < 0) || (s >= length_ && along > 0))) {
+        /* beyond an end: straight continuation of the end tangent */
+        f->s += along;
+        f->ds[0] = tx;
+        f->ds[1] = ty;
+        return covered;
+    }
+    const double kappa = (dc[0] * ddc[1] - dc[1] * ddc[0]) / (norm * norm * norm);
+    const double stretch = 1 - kappa * f->d;
+    f->ds[0] = tx / stretch;
+    f->ds[1] = ty / stretch;
+    return covered;
+}
+
+void road_frenet(const double* p, double x, double y, double* s, double* d, double ds[2], double dd[2])
+{
+    const double* road = p + kParamRoad;
+    const double tx = std::cos(road[kRoadTheta]), ty = std::sin(road[kRoadTheta]);
+    const double kappa = road[kRoadKappa];
+    const double ex = x - road[kRoadX], ey = y - road[kRoadY];
+    const double lon = tx * ex + ty * ey;
+    const double lat = -ty * ex + tx * ey;
+
+    /* s = lon (1 + kappa lat), d = lat - kappa lon^2 / 2 */
+    if (s) *s = lon * (1 + kappa * lat);
+    if (d) *d = lat - kappa * lon * lon / 2;
+    if (ds) {
+        ds[0] = tx * (1 + kappa * lat) - ty * kappa * lon;
+        ds[1] = ty * (1 + kappa * lat) + tx * kappa * lon;
+    }
+    if (dd) {
+        dd[0] = -ty - kappa * lon * tx;
+        dd[1] = tx - kappa * lon * ty;
+    }
+}
+
+void write_road_params(const ReferencePath& path, const double s[kStages], double* all_parameters, double mass,
+                       double inertia)
+{
+    for (int k = 0; k < kStages; k++) {
+        double* p = all_parameters + kRoadStageParams * k;
+        PathPoint point = path.point(s[k]);
+        p[0] = mass;
+        p[1] = inertia;
+        p[kParamRoad + kRoadX] = point.x;
+        p[kParamRoad + kRoadY] = point.y;
+        p[kParamRoad + kRoadTheta] = point.theta;
+        p[kParamRoad + kRoadKappa] = point.kappa;
+        p[kParamRoad + kRoadLeft] = path.config().left_width;
+        p[kParamRoad + kRoadRight] = path.config().right_width;
+    }
+}
+
+}  /* namespace mpc_planner */
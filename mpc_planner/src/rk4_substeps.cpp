@@ -0,0 +1,114 @@
+#include "mpc_planner/rk4_substeps.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "mpc_planner/vehicle_model.h"
+
+namespace mpc_planner {
+
+namespace {
+
+constexpr int kSeeds = kCarStates + kCarInputs;
+
+/* state with its tangents w.r.t. [x u] of the start of the stage */
+struct Tangent {
+    double value[kCarStates];
+    double d[kCarStates][kSeeds];
+};
+
+/* k = f(x, u) and dk = A(x) dx + [0 B] */
+void dynamics_tangent(const Tangent& x, const double u[kCarInputs], double m, double I, bool derivatives, Tangent* k)
+{
+    car_dynamics(x.value, u, m, I, k->value);
+    if (!derivatives) return;
+    double A[kCarStates][kCarStates], B[kCarStates][kCarInputs];
+    car_jacobian(x.value, m, I, A, B);
+    for (int r = 0; r < kCarStates; r++) {
+        for (int j = 0; j < kSeeds; j++) {
+            double d = j < kCarStates ? 0 : B[r][j - kCarStates];
+            for (int q = 0; q < kCarStates; q++) d += A[r][q] * x.d[q][j];
+            k->d[r][j] = d;
+        }
+    }
+}
+
+/* out = x + a * k, values and tangents */
+void axpy(const Tangent& x, double a, const Tangent& k, bool derivatives, Tangent* out)
+{
+    for (int r = 0; r < kCarStates; r++) {
+        out->value[r] = x.value[r] + a * k.value[r];
+        if (!derivatives) continue;
+        for (int j = 0; j < kSeeds; j++) out->d[r][j] = x.d[r][j] + a * k.d[r][j];
+    }
+}
+
+}  /* namespace */
+
+void car_rk4_substeps(const double x[kCarStates], const double u[kCarInputs], double m, double I, double h,
+                      int substeps, double x_next[kCarStates], double dx[kCarStates][kCarStates],
+                      double du[kCarStates][kCarInputs])
+{
+    substeps = std::max(substeps, 1);
+    const double step = h / substeps;
+    const bool derivatives = dx || du;
+
+    Tangent state, k1, k2, k3, k4, tmp;
+    std::memcpy(state.value, x, sizeof(state.value));
+    std::memset(state.d, 0, sizeof(state.d));
+    for (int r = 0; r < kCarStates; r++) state.d[r][r] = 1;
+
+    for (int n = 0; n < substeps; n++) {
+        dynamics_tangent(state, u, m, I, derivatives, &k1);
+        axpy(state, 0.5 * step, k1, derivatives, &tmp);
+        dynamics_tangent(tmp, u, m, I, derivatives, &k2);
+        axpy(state, 0.5 * step, k2, derivatives, &tmp);
+        dynamics_tangent(tmp, u, m, I, derivatives, &k3);
+        axpy(state, step, k3, derivatives, &tmp);
+        dynamics_tangent(tmp, u, m, I, derivatives, &k4);
+        for (int r = 0; r < kCarStates; r++) {
+            state.value[r] += step / 6 * (k1.value[r] + 2 * k2.value[r] + 2 * k3.value[r] + k4.value[r]);
+            if (!derivatives) continue;
+            for (int j = 0; j < kSeeds; j++) {
+                state.d[r][j] += step / 6 * (k1.d[r][j] + 2 * k2.d[r][j] + 2 * k3.d[r][j] + k4.d[r][j]);
+            }
+        }
+    }
+
+    std::memcpy(x_next, state.value, sizeof(state.value));
+    for (int r = 0; r < kCarStates; r++) {
+        if (dx) {
+            for (int j = 0; j < kCarStates; j++) dx[r][j] = state.d[r][j];
+        }
+        if (du) {
+            for (int j = 0; j < kCarInputs; j++) du[r][j] = state.d[r][kCarStates + j];
+        }
+    }
+}
+
+void ego_rk4_substeps(const double z[kEgoStageVars], const double* p, double h, int substeps,
+                      double c[kCarStates], double nabla_c[kCarStates * kEgoStageVars])
+{
+    double x_next[kCarStates];
+    double dx[kCarStates][kCarStates], du[kCarStates][kCarInputs];
+    car_rk4_substeps(z + kCarInputs, z, p[kParamMass], p[kParamInertia], h, substeps, x_next,
+                     nabla_c ? dx : nullptr, nabla_c ? du : nullptr);
+    if (c) std::memcpy(c, x_next, sizeof(x_next));
+    if (nabla_c) {
+        for (int r = 0; r < kCarStates; r++) {
+            for (int j = 0; j < kCarInputs; j++) nabla_c[j * kCarStates + r] = du[r][j];
+            for (int j = 0; j < kCarStates; j++) nabla_c[(kCarInputs + j) * kCarStates + r] = dx[r][j];
+        }
+    }
+}
+
+void model_rk4_substeps(const double x[kStates], const double u[kInputs], const double p[kStageParams], double h,
+                        int substeps, double x_next[kStates])
+{
+    car_rk4_substeps(x, u, p[0], p[1], h, substeps, x_next);
+    for (int i = 1; i <= kObstacles; i++) {
+        car_rk4_substeps(x + kCarStates * i, u + kCarInputs * i, 1, 1, h, substeps, x_next + kCarStates * i);
+    }
+}
+
+}  /* namespace mpc_planner */
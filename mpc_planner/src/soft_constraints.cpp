@@ -0,0 +1,84 @@
+#include "mpc_planner/soft_constraints.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mpc_planner {
+
+namespace {
+
+/*
+ * signed violation of a row, negative inside its bounds, w.r.t. the nearer
+ * bound and its sign w.r.t. h: +1 for hu, -1 for hl; -inf if both are infinite
+ */
+double violation(double h, double hl, double hu, double* sign)
+{
+    const double none = -std::numeric_limits<double>::infinity();
+    const double below = std::isfinite(hl) ? hl - h : none;
+    const double above = std::isfinite(hu) ? h - hu : none;
+    *sign = above >= below ? 1 : -1;
+    return std::max(below, above);
+}
+
+}  /* namespace */
+
+double soft_penalty(double v, double l1, double l2, double smoothing, double* d1, double* d2)
+{
+    if (!(v > -smoothing)) {
+        if (d1) *d1 = 0;
+        if (d2) *d2 = 0;
+        return 0;
+    }
+    /* huber(u) = u^2 / (2 e) up to e, u - e / 2 beyond, at u = v + e */
+    const double u = v + smoothing;
+    double huber, slope, curvature;
+    if (v < 0) {
+        huber = u * u / (2 * smoothing);
+        slope = u / smoothing;
+        curvature = 1 / smoothing;
+    } else {
+        huber = u - smoothing / 2;
+        slope = 1;
+        curvature = 0;
+    }
+    const double excess = std::max(v, 0.0);
+    if (d1) *d1 = l1 * slope + l2 * excess;
+    if (d2) *d2 = l1 * curvature + (v > 0 ? l2 : 0);
+    return l1 * huber + l2 * excess * excess / 2;
+}
+
+void soften(const SoftRow* rows, int count, int nh, int nvar, const double* h, const double* nabla_h,
+            const double* hl, const double* hu, double smoothing, double* f, double* nabla_f, double* H)
+{
+    for (int i = 0; i < count; i++) {
+        const int r = rows[i].row;
+        double sign, d1, d2;
+        const double v = violation(h[r], hl[r], hu[r], &sign);
+        if (!(v > -smoothing)) continue;
+        const double penalty = soft_penalty(v, rows[i].l1, rows[i].l2, smoothing, &d1, &d2);
+        if (f) *f += penalty;
+        if (!nabla_h) continue;
+
+        /* dv/dz = sign * dh/dz; Gauss-Newton: d2 dv/dz dv/dz' */
+        for (int a = 0; a < nvar; a++) {
+            const double ga = nabla_h[a * nh + r];
+            if (ga == 0) continue;
+            if (nabla_f) nabla_f[a] += d1 * sign * ga;
+            if (!H) continue;
+            for (int b = 0; b < nvar; b++) H[b * nvar + a] += d2 * ga * nabla_h[b * nh + r];
+        }
+    }
+}
+
+double soft_violation(const SoftRow* rows, int count, const double* h, const double* hl, const double* hu)
+{
+    double largest = 0, sign;
+    for (int i = 0; i < count; i++) {
+        const int r = rows[i].row;
+        largest = std::max(largest, violation(h[r], hl[r], hu[r], &sign));
+    }
+    return largest;
+}
+
+}  /* namespace mpc_planner */
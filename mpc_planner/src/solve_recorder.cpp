@@ -0,0 +1,324 @@
+#include "mpc_planner/solve_recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace mpc_planner {
+
+static const char kLogMagic[8] = { 'F', 'N', 'L', 'P', 'S', 'L', 'O', 'G' };
+static constexpr std::uint32_t kLogVersion = 2;
+static constexpr std::uint32_t kFrameSync = 0x454d5246;  /* "FRME" */
+
+enum FrameKind : std::uint32_t { kKeyframe = 0, kDelta = 1 };
+
+struct LogHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_bytes;
+};
+
+struct FrameHeader {
+    std::uint32_t sync;
+    std::uint32_t bytes;
+    std::uint32_t kind;
+    std::uint32_t crc;   /* of bytes, kind and the payload */
+};
+
+/* encode() emits at most one run of two varints and one literal of 9 bytes per word */
+static constexpr std::uint32_t kMaxFrameBytes = kRecordWords * (2 * 10 + 9);
+
+/* CRC-32 (IEEE 802.3) of N bytes at DATA, continuing from CRC */
+static std::uint32_t crc32(std::uint32_t crc, const void* data, std::size_t n)
+{
+    static const struct Table {
+        std::uint32_t entries[256];
+        Table()
+        {
+            for (std::uint32_t i = 0; i < 256; i++) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                entries[i] = c;
+            }
+        }
+    } table;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (std::size_t i = 0; i < n; i++) crc = table.entries[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static std::uint32_t frame_crc(const FrameHeader& frame, const unsigned char* payload)
+{
+    std::uint32_t crc = crc32(0, &frame.bytes, sizeof(frame.bytes));
+    crc = crc32(crc, &frame.kind, sizeof(frame.kind));
+    return crc32(crc, payload, frame.bytes);
+}
+
+static void put_varint(std::vector<unsigned char>* out, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        out->push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<unsigned char>(value));
+}
+
+static bool get_varint(const unsigned char** in, const unsigned char* end, std::uint64_t* value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64 && *in < end; shift += 7) {
+        unsigned char byte = *(*in)++;
+        *value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+/* WORDS xor REFERENCE (zeros if nullptr), see the log format */
+static void encode(const std::uint64_t* words, const std::uint64_t* reference, std::vector<unsigned char>* out)
+{
+    out->clear();
+    int i = 0;
+    while (i < kRecordWords) {
+        int zeros = 0;
+        while (i + zeros < kRecordWords && words[i + zeros] == (reference ? reference[i + zeros] : 0)) zeros++;
+        int literals = 0;
+        while (i + zeros + literals < kRecordWords
+               && words[i + zeros + literals] != (reference ? reference[i + zeros + literals] : 0)) {
+            literals++;
+        }
+        put_varint(out, zeros);
+        put_varint(out, literals);
+        for (int j = i + zeros; j < i + zeros + literals; j++) {
+            std::uint64_t x = words[j] ^ (reference ? reference[j] : 0);
+            int n = 8;
+            while (n > 1 && !(x >> (8 * (n - 1)))) n--;
+            out->push_back(static_cast<unsigned char>(n));
+            for (int b = 0; b < n; b++) out->push_back(static_cast<unsigned char>(x >> (8 * b)));
+        }
+        i += zeros + literals;
+    }
+}
+
+/* inverse of encode, in place on WORDS which hold the reference */
+static bool decode(const unsigned char* in, const unsigned char* end, std::uint64_t* words)
+{
+    int i = 0;
+    while (i < kRecordWords) {
+        std::uint64_t zeros, literals;
+        if (!get_varint(&in, end, &zeros) || !get_varint(&in, end, &literals)) return false;
+        if (zeros + literals == 0 || zeros + literals > static_cast<std::uint64_t>(kRecordWords - i)) return false;
+        i += static_cast<int>(zeros);
+        for (std::uint64_t j = 0; j < literals; j++, i++) {
+            if (in >= end) return false;
+            int n = *in++;
+            if (n < 1 || n > 8 || end - in < n) return false;
+            std::uint64_t x = 0;
+            for (int b = 0; b < n; b++) x |= static_cast<std::uint64_t>(*in++) << (8 * b);
+            words[i] ^= x;
+        }
+    }
+    return in == end;
+}
+
+SolveRecorder::SolveRecorder(const SolveRecorderConfig& config)
+    : config_(config),
+      slots_(new Slot[std::max(config.slots, 1)]()),
+      previous_(new Slot())
+{
+    config_.slots = std::max(config_.slots, 1);
+    config_.keyframe_interval = std::max(config_.keyframe_interval, 1);
+    buffer_.reserve(sizeof(Slot) + sizeof(Slot) / 4);
+
+    file_ = std::fopen(config_.path.c_str(), "ab+");
+    if (!file_) {
+        error_ = "cannot open " + config_.path;
+        return;
+    }
+    LogHeader header;
+    std::memcpy(header.magic, kLogMagic, sizeof(header.magic));
+    header.version = kLogVersion;
+    header.record_bytes = sizeof(SolveRecord);
+    std::fseek(file_, 0, SEEK_END);
+    if (std::ftell(file_) == 0) {
+        if (std::fwrite(&header, sizeof(header), 1, file_) != 1) error_ = "cannot write " + config_.path;
+    } else {
+        /* appending: the records start again from a keyframe */
+        LogHeader existing;
+        std::rewind(file_);
+        if (std::fread(&existing, sizeof(existing), 1, file_) != 1 || std::memcmp(&existing, &header, sizeof(header))) {
+            error_ = config_.path + " is not a solve log of this version and solver";
+        }
+        std::fseek(file_, 0, SEEK_END);
+    }
+    if (!error_.empty()) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return;
+    }
+    ok_ = true;
+    writer_ = std::thread(&SolveRecorder::writer_loop, this);
+}
+
+SolveRecorder::~SolveRecorder()
+{
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            quit_ = true;
+        }
+        wake_.notify_all();
+        writer_.join();
+    }
+    if (file_) std::fclose(file_);
+}
+
+bool SolveRecorder::record(double stamp, double deadline, int guess, const FORCESNLPsolver_params& params,
+                           const FORCESNLPsolver_output& output, int exitflag, const FORCESNLPsolver_info& info)
+{
+    if (!ok_) return false;
+    const unsigned long head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= static_cast<unsigned long>(config_.slots)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /* the words past the record and any padding inside it stay zero */
+    Slot& slot = slots_[head % config_.slots];
+    SolveRecord* record = reinterpret_cast<SolveRecord*>(slot.words);
+    record->stamp = stamp;
+    record->deadline = deadline;
+    record->exitflag = exitflag;
+    record->guess = guess;
+    std::memcpy(&record->params, &params, sizeof(params));
+    std::memcpy(&record->output, &output, sizeof(output));
+    std::memcpy(&record->info, &info, sizeof(info));
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void SolveRecorder::writer_loop()
+{
+    const auto period = std::chrono::duration<double>(config_.flush_period);
+
+    for (;;) {
+        unsigned long tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            std::fflush(file_);
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (quit_ && tail == head_.load(std::memory_order_acquire)) break;
+            wake_.wait_for(lock, period);
+            continue;
+        }
+        write_record(slots_[tail % config_.slots]);
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+}
+
+void SolveRecorder::write_record(const Slot& slot)
+{
+    const bool key = written_ % config_.keyframe_interval == 0;
+    encode(slot.words, key ? nullptr : previous_->words, &buffer_);
+    std::memcpy(previous_->words, slot.words, sizeof(slot.words));
+    written_++;
+    if (failed_.load(std::memory_order_relaxed)) return;
+
+    FrameHeader frame;
+    frame.sync = kFrameSync;
+    frame.bytes = static_cast<std::uint32_t>(buffer_.size());
+    frame.kind = key ? kKeyframe : kDelta;
+    frame.crc = frame_crc(frame, buffer_.data());
+    if (std::fwrite(&frame, sizeof(frame), 1, file_) != 1
+        || std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+        failed_.store(true, std::memory_order_relaxed);
+        return;
+    }
+    bytes_.fetch_add(sizeof(frame) + buffer_.size(), std::memory_order_relaxed);
+}
+
+SolveLogReader::~SolveLogReader()
+{
+    if (file_) std::fclose(file_);
+}
+
+bool SolveLogReader::open(const std::string& path)
+{
+    if (file_) std::fclose(file_);
+    have_key_ = false;
+    skipped_ = 0;
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+    LogHeader header;
+    if (std::fread(&header, sizeof(header), 1, file_) != 1 || std::memcmp(header.magic, kLogMagic, sizeof(kLogMagic))) {
+        error_ = path + " is not a solve log";
+    } else if (header.version != kLogVersion || header.record_bytes != sizeof(SolveRecord)) {
+        error_ = path + " was written for another version or solver";
+    } else {
+        words_.reset(new std::uint64_t[kRecordWords]);
+        return true;
+    }
+    std::fclose(file_);
+    file_ = nullptr;
+    return false;
+}
+
+bool SolveLogReader::resync(long offset)
+{
+    /* the deltas after a lost frame lost their reference */
+    skipped_++;
+    have_key_ = false;
+    if (std::fseek(file_, offset, SEEK_SET) != 0) return false;
+    unsigned char window[4];
+    int c, read = 0;
+    while ((c = std::fgetc(file_)) != EOF) {
+        std::memmove(window, window + 1, 3);
+        window[3] = static_cast<unsigned char>(c);
+        std::uint32_t sync;
+        std::memcpy(&sync, window, sizeof(sync));
+        if (++read >= 4 && sync == kFrameSync) return std::fseek(file_, -4, SEEK_CUR) == 0;
+    }
+    return false;
+}
+
+bool SolveLogReader::next(SolveRecord* record)
+{
+    if (!file_) return false;
+    FrameHeader frame;
+    for (;;) {
+        const long start = std::ftell(file_);
+        if (std::fread(&frame, sizeof(frame), 1, file_) != 1) return false;
+
+        /* a corrupt header must not make us allocate its size; resume at the next sync word */
+        if (frame.sync != kFrameSync || frame.bytes > kMaxFrameBytes || (frame.kind != kKeyframe && frame.kind != kDelta)) {
+            if (!resync(start + 1)) return false;
+            continue;
+        }
+        buffer_.resize(frame.bytes);
+        if (std::fread(buffer_.data(), 1, frame.bytes, file_) != frame.bytes
+            || frame_crc(frame, buffer_.data()) != frame.crc) {
+            /* a short read is a cut off log or a corrupt size */
+            if (!resync(start + 1)) return false;
+            continue;
+        }
+
+        if (frame.kind == kKeyframe) {
+            std::memset(words_.get(), 0, sizeof(std::uint64_t) * kRecordWords);
+        } else if (!have_key_) {
+            skipped_++;
+            continue;
+        }
+        have_key_ = decode(buffer_.data(), buffer_.data() + buffer_.size(), words_.get());
+        if (!have_key_) {
+            skipped_++;
+            continue;
+        }
+        std::memcpy(record, words_.get(), sizeof(*record));
+        return true;
+    }
+}
+
+}  /* namespace mpc_planner */
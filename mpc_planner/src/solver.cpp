@@ -0,0 +1,92 @@
+#include "mpc_planner/solver.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "mpc_planner/iteration_telemetry.h"
+
+namespace mpc_planner {
+
+#ifdef _WIN32
+static const char* kNullDevice = "NUL";
+#else
+static const char* kNullDevice = "/dev/null";
+#endif
+
+Solver::Solver(std::FILE* log)
+    : ext_func_(FORCESNLPsolver_casadi2forces), telemetry_(nullptr), log_(log), own_log_(false), solved_(false)
+{
+    if (!log_) {
+        /* the solver prints to stdout when given no stream */
+        log_ = std::fopen(kNullDevice, "w");
+        own_log_ = log_ != nullptr;
+    }
+    std::memset(&output_, 0, sizeof(output_));
+    std::memset(&info_, 0, sizeof(info_));
+    reset();
+}
+
+Solver::~Solver()
+{
+    if (own_log_) std::fclose(log_);
+}
+
+void Solver::reset()
+{
+    for (int k = 0; k < kStages; k++) {
+        for (int i = 0; i < kStageVars; i++) {
+            params_.x0[kStageVars * k + i] = kLowerBounds[i] + (kUpperBounds[i] - kLowerBounds[i]) / 2;
+        }
+        params_.all_parameters[kStageParams * k] = kMass;
+        params_.all_parameters[kStageParams * k + 1] = kInertia;
+    }
+    solved_ = false;
+}
+
+void Solver::warm_start(int shift)
+{
+    if (!solved_) return;
+    const double* z = reinterpret_cast<const double*>(&output_);
+    shift = std::max(0, shift);
+    for (int k = 0; k < kStages; k++) {
+        /* stages beyond the horizon repeat the last one */
+        int src = std::min(k + shift, kStages - 1);
+        std::memcpy(params_.x0 + kStageVars * k, z + kStageVars * src, sizeof(double) * kStageVars);
+    }
+}
+
+int Solver::solve(const double xinit[kStates], Trajectory* out)
+{
+    std::memcpy(params_.xinit, xinit, sizeof(params_.xinit));
+    int exitflag;
+    if (telemetry_) {
+        telemetry_->begin(ext_func_);
+        exitflag = FORCESNLPsolver_solve(&params_, &output_, &info_, log_, IterationTelemetry::ext_func);
+        telemetry_->end();
+    } else {
+        exitflag = FORCESNLPsolver_solve(&params_, &output_, &info_, log_, ext_func_);
+    }
+    solved_ = exitflag == FORCESNLPsolver_OPTIMAL;
+
+    if (out) {
+        std::memcpy(out->z, &output_, sizeof(out->z));
+        out->exitflag = exitflag;
+        out->iterations = info_.it;
+        out->solvetime = info_.solvetime;
+        out->set_uniform(kStepSize);
+        out->fallback = false;
+    }
+    return exitflag;
+}
+
+void Solver::extended_info(ExtendedInfo* out) const
+{
+    *out = ExtendedInfo();
+    out->info = info_;
+    if (!telemetry_) return;
+    out->time = telemetry_->totals();
+    out->counters = telemetry_->counter_totals();
+    out->counted = telemetry_->counting();
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,225 @@
+#include "mpc_planner/terminal_cost.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "mpc_planner/rk4_substeps.h"
+
+namespace mpc_planner {
+
+namespace {
+
+constexpr int kN = kCarStates;
+constexpr int kM = kCarInputs;
+
+/* inverse of the symmetric positive definite P by Gauss-Jordan elimination; false if singular */
+bool invert(const double P[kN][kN], double inverse[kN][kN])
+{
+    double a[kN][2 * kN];
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kN; j++) {
+            a[i][j] = P[i][j];
+            a[i][kN + j] = i == j;
+        }
+    }
+    for (int k = 0; k < kN; k++) {
+        int p = k;
+        for (int i = k + 1; i < kN; i++) {
+            if (std::fabs(a[i][k]) > std::fabs(a[p][k])) p = i;
+        }
+        if (a[p][k] == 0) return false;
+        for (int j = 0; j < 2 * kN; j++) std::swap(a[k][j], a[p][j]);
+        const double pivot = a[k][k];
+        for (int j = 0; j < 2 * kN; j++) a[k][j] /= pivot;
+        for (int i = 0; i < kN; i++) {
+            if (i == k) continue;
+            const double factor = a[i][k];
+            for (int j = 0; j < 2 * kN; j++) a[i][j] -= factor * a[k][j];
+        }
+    }
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kN; j++) inverse[i][j] = a[i][kN + j];
+    }
+    return true;
+}
+
+/* K = (R + B'PB)^-1 B'PA and the Riccati update Q + A'PA - (B'PA)' K */
+void riccati_step(const double A[kN][kN], const double B[kN][kM], const double Q[kN], const double R[kM],
+                  const double P[kN][kN], double K[kM][kN], double next[kN][kN])
+{
+    double PA[kN][kN], PB[kN][kM];
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kN; j++) {
+            PA[i][j] = 0;
+            for (int k = 0; k < kN; k++) PA[i][j] += P[i][k] * A[k][j];
+        }
+        for (int j = 0; j < kM; j++) {
+            PB[i][j] = 0;
+            for (int k = 0; k < kN; k++) PB[i][j] += P[i][k] * B[k][j];
+        }
+    }
+    double S[kM][kM], BPA[kM][kN];
+    for (int i = 0; i < kM; i++) {
+        for (int j = 0; j < kM; j++) {
+            S[i][j] = i == j ? R[i] : 0;
+            for (int k = 0; k < kN; k++) S[i][j] += B[k][i] * PB[k][j];
+        }
+        for (int j = 0; j < kN; j++) {
+            BPA[i][j] = 0;
+            for (int k = 0; k < kN; k++) BPA[i][j] += B[k][i] * PA[k][j];
+        }
+    }
+    const double det = S[0][0] * S[1][1] - S[0][1] * S[1][0];
+    const double Si[kM][kM] = { { S[1][1] / det, -S[0][1] / det }, { -S[1][0] / det, S[0][0] / det } };
+    for (int i = 0; i < kM; i++) {
+        for (int j = 0; j < kN; j++) K[i][j] = Si[i][0] * BPA[0][j] + Si[i][1] * BPA[1][j];
+    }
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kN; j++) {
+            double value = i == j ? Q[i] : 0;
+            for (int k = 0; k < kN; k++) value += A[k][i] * PA[k][j];
+            for (int k = 0; k < kM; k++) value -= BPA[k][i] * K[k][j];
+            next[i][j] = value;
+        }
+    }
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < i; j++) next[i][j] = next[j][i] = (next[i][j] + next[j][i]) / 2;
+    }
+}
+
+}  /* namespace */
+
+bool terminal_ingredients(const TerminalConfig& config, const double x_ref[kCarStates],
+                          const double u_ref[kCarInputs], const double p[kStageParams], TerminalCost* terminal)
+{
+    double x_next[kN], A[kN][kN], B[kN][kM];
+    car_rk4_substeps(x_ref, u_ref, p[0], p[1], config.step, config.substeps, x_next, A, B);
+    std::copy(x_ref, x_ref + kN, terminal->x_ref);
+    std::copy(u_ref, u_ref + kM, terminal->u_ref);
+
+    double P[kN][kN] = {}, next[kN][kN];
+    for (int i = 0; i < kN; i++) P[i][i] = config.state_weight[i];
+    bool converged = false;
+    int it = 0;
+    while (it < config.max_iterations && !converged) {
+        riccati_step(A, B, config.state_weight, config.input_weight, P, terminal->K, next);
+        it++;
+        double change = 0, size = 1;
+        for (int i = 0; i < kN; i++) {
+            for (int j = 0; j < kN; j++) {
+                if (!std::isfinite(next[i][j])) return false;
+                change = std::max(change, std::fabs(next[i][j] - P[i][j]));
+                size = std::max(size, std::fabs(next[i][j]));
+                P[i][j] = next[i][j];
+            }
+        }
+        converged = change <= config.tolerance * size;
+    }
+    terminal->iterations = it;
+    if (!converged) return false;
+    riccati_step(A, B, config.state_weight, config.input_weight, P, terminal->K, next);
+    std::copy(&P[0][0], &P[0][0] + kN * kN, &terminal->P[0][0]);
+
+    /* largest level set in which every bound holds: margin^2 / (g' P^-1 g) for each bounded g' e */
+    double Pi[kN][kN];
+    if (!invert(P, Pi)) return false;
+    double alpha = kInf;
+    for (int i = 0; i < kEgoStageVars; i++) {
+        double g[kN], center;
+        if (i < kCarInputs) {
+            for (int j = 0; j < kN; j++) g[j] = -terminal->K[i][j];
+            center = u_ref[i];
+        } else {
+            for (int j = 0; j < kN; j++) g[j] = j == i - kCarInputs;
+            center = x_ref[i - kCarInputs];
+        }
+        const double margin = std::min(kEgoUpperBounds[i] - center, center - kEgoLowerBounds[i]);
+        double spread = 0;
+        for (int a = 0; a < kN; a++) {
+            for (int b = 0; b < kN; b++) spread += g[a] * Pi[a][b] * g[b];
+        }
+        if (margin <= 0) {
+            alpha = 0;
+        } else if (spread > 0) {
+            alpha = std::min(alpha, margin * margin / spread);
+        }
+    }
+    terminal->alpha = config.set_scale * alpha;
+    return true;
+}
+
+void terminal_cost(const TerminalCost& terminal, const double z[kEgoStageVars], double* f, double* nabla_f,
+                   double* H)
+{
+    double e[kN], Pe[kN];
+    for (int i = 0; i < kN; i++) e[i] = z[kCarInputs + i] - terminal.x_ref[i];
+    double value = 0;
+    for (int i = 0; i < kN; i++) {
+        Pe[i] = 0;
+        for (int j = 0; j < kN; j++) Pe[i] += terminal.P[i][j] * e[j];
+        value += e[i] * Pe[i];
+    }
+    if (f) *f += value / 2;
+    if (nabla_f) {
+        for (int i = 0; i < kN; i++) nabla_f[kCarInputs + i] += Pe[i];
+    }
+    if (H) {
+        for (int i = 0; i < kN; i++) {
+            for (int j = 0; j < kN; j++) H[(kCarInputs + j) * kEgoStageVars + kCarInputs + i] += terminal.P[i][j];
+        }
+    }
+}
+
+void terminal_set(const TerminalCost& terminal, const double z[kEgoStageVars], int row, int nh, double* h,
+                  double* nabla_h)
+{
+    double e[kN];
+    for (int i = 0; i < kN; i++) e[i] = z[kCarInputs + i] - terminal.x_ref[i];
+    double value = 0;
+    for (int i = 0; i < kN; i++) {
+        double Pe = 0;
+        for (int j = 0; j < kN; j++) Pe += terminal.P[i][j] * e[j];
+        value += e[i] * Pe;
+        if (nabla_h) nabla_h[(kCarInputs + i) * nh + row] = 2 * Pe;
+    }
+    if (h) h[row] = value - terminal.alpha;
+}
+
+void set_terminal_params(double* all_parameters, int stages, const TerminalCost& terminal)
+{
+    for (int k = 0; k < stages; k++) {
+        double* block = all_parameters + kTerminalStageParams * k + kParamTerminal;
+        std::fill(block, block + kTerminalParams, 0.0);
+        block[kTerminalAlpha] = 1;
+    }
+
+    double* p = all_parameters + kTerminalStageParams * (stages - 1);
+    double* track = p + kParamTracking;
+    double* block = p + kParamTerminal;
+    for (int i = 0; i < kN; i++) {
+        track[kTrackReference + kCarInputs + i] = terminal.x_ref[i];
+        track[kTrackWeight + kCarInputs + i] = 0;
+    }
+    for (int i = 0; i < kM; i++) track[kTrackReference + i] = terminal.u_ref[i];
+
+    /* Cholesky factor, P = L L' */
+    double L[kN][kN] = {};
+    for (int j = 0; j < kN; j++) {
+        double d = terminal.P[j][j];
+        for (int k = 0; k < j; k++) d -= L[j][k] * L[j][k];
+        L[j][j] = std::sqrt(std::max(d, 0.0));
+        for (int i = j + 1; i < kN; i++) {
+            double s = terminal.P[i][j];
+            for (int k = 0; k < j; k++) s -= L[i][k] * L[j][k];
+            L[i][j] = L[j][j] > 0 ? s / L[j][j] : 0;
+        }
+    }
+    int index = kTerminalFactor;
+    for (int j = 0; j < kN; j++) {
+        for (int i = j; i < kN; i++) block[index++] = L[i][j];
+    }
+    block[kTerminalAlpha] = terminal.alpha;
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,69 @@
+#include "mpc_planner/time_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mpc_planner {
+
+/* time spanned by N steps growing by RATIO from FIRST */
+static double geometric_span(double first, double ratio, int n)
+{
+    double span = 0, step = first;
+    for (int k = 0; k < n; k++) {
+        span += step;
+        step *= ratio;
+    }
+    return span;
+}
+
+int make_time_grid(const TimeGridConfig& config, double step[kStages])
+{
+    std::fill(step, step + kStages, 0.0);
+    /* the bisection below never ends for first_step < 0 and yields NaN steps for 0 */
+    const bool positive = config.first_step > 0 && config.horizon > 0;
+    if (!positive || !std::isfinite(config.first_step) || !std::isfinite(config.horizon)) return 0;
+
+    const int stages = std::min(std::max(config.stages, 1), kStages);
+    const int n = stages - 1;
+    if (n == 0) return stages;
+
+    double first = config.first_step;
+    double ratio = 1;
+    if (first * n >= config.horizon) {
+        first = config.horizon / n;
+    } else {
+        /* bisection on the growth ratio; the span grows monotonically with it */
+        double lo = 1, hi = 2;
+        while (geometric_span(first, hi, n) < config.horizon) hi *= 2;
+        for (int it = 0; it < 60; it++) {
+            double mid = (lo + hi) / 2;
+            if (geometric_span(first, mid, n) < config.horizon) lo = mid; else hi = mid;
+        }
+        ratio = (lo + hi) / 2;
+    }
+
+    double h = first;
+    for (int k = 0; k < n; k++) {
+        step[k] = h;
+        h *= ratio;
+    }
+    return stages;
+}
+
+void grid_times(const double step[kStages], double time[kStages])
+{
+    time[0] = 0;
+    for (int k = 1; k < kStages; k++) time[k] = time[k - 1] + step[k - 1];
+}
+
+void write_time_grid(const double step[kStages], double* all_parameters, double mass, double inertia)
+{
+    for (int k = 0; k < kStages; k++) {
+        double* p = all_parameters + kGridStageParams * k;
+        p[0] = mass;
+        p[1] = inertia;
+        p[kParamStep] = step[k];
+    }
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,68 @@
+#include "mpc_planner/tracking_cost.h"
+
+#include <algorithm>
+
+namespace mpc_planner {
+
+void tracking_cost(const double z[kEgoStageVars], const double* p, double* f, double* nabla_f, double* H)
+{
+    const double* track = p + kParamTracking;
+    const double* reference = track + kTrackReference;
+    const double* weight = track + kTrackWeight;
+    const double radius = track[kTrackLaneRadius], lane_weight = track[kTrackLaneWeight];
+    const int ix = kCarInputs + kX, iy = kCarInputs + kY;
+    const double x = z[ix], y = z[iy];
+    const double lane = x * x + y * y - radius * radius;
+
+    if (f) {
+        double cost = lane_weight * lane * lane;
+        for (int i = 0; i < kEgoStageVars; i++) cost += weight[i] * (z[i] - reference[i]) * (z[i] - reference[i]);
+        *f += cost / 2;
+    }
+    if (nabla_f) {
+        for (int i = 0; i < kEgoStageVars; i++) nabla_f[i] = weight[i] * (z[i] - reference[i]);
+        nabla_f[ix] += 2 * lane_weight * lane * x;
+        nabla_f[iy] += 2 * lane_weight * lane * y;
+    }
+    if (H) {
+        std::fill(H, H + kEgoStageVars * kEgoStageVars, 0.0);
+        for (int i = 0; i < kEgoStageVars; i++) H[i * kEgoStageVars + i] = weight[i];
+        H[ix * kEgoStageVars + ix] += 4 * lane_weight * x * x;
+        H[iy * kEgoStageVars + iy] += 4 * lane_weight * y * y;
+        H[ix * kEgoStageVars + iy] += 4 * lane_weight * x * y;
+        H[iy * kEgoStageVars + ix] += 4 * lane_weight * x * y;
+    }
+}
+
+void set_tracking_reference(double* stage_params, const TrackingReference& reference)
+{
+    double* track = stage_params + kParamTracking;
+    std::copy(reference.z, reference.z + kEgoStageVars, track + kTrackReference);
+    std::copy(reference.weight, reference.weight + kEgoStageVars, track + kTrackWeight);
+    track[kTrackLaneRadius] = reference.lane_radius;
+    track[kTrackLaneWeight] = reference.lane_weight;
+}
+
+TrackingReference lane_reference(double lane_radius)
+{
+    /* 0.1*(F^2 + 0.1*s^2 + 0.1*(x^2+y^2-2.25)^2) */
+    TrackingReference reference = {};
+    reference.weight[kForce] = 0.2;
+    reference.weight[kSteer] = 0.02;
+    reference.lane_radius = lane_radius;
+    reference.lane_weight = 0.02;
+    return reference;
+}
+
+TrackingReference goal_reference(double x, double y)
+{
+    /* 100*(x-1.5)^2 + 100*y^2 */
+    TrackingReference reference = {};
+    reference.z[kCarInputs + kX] = x;
+    reference.z[kCarInputs + kY] = y;
+    reference.weight[kCarInputs + kX] = 200;
+    reference.weight[kCarInputs + kY] = 200;
+    return reference;
+}
+
+}  /* namespace mpc_planner */
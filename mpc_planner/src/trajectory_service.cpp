@@ -0,0 +1,122 @@
+#include "mpc_planner/trajectory_service.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mpc_planner/vehicle_model.h"
+
+namespace mpc_planner {
+
+bool TrajectoryService::publish(const Trajectory& trajectory, double mass, double inertia)
+{
+    Slot* current = current_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (Slot& candidate : slots_) {
+        /* pairs with the sequentially consistent pin in acquire() */
+        if (&candidate != current && candidate.readers.load() == 0) {
+            slot = &candidate;
+            break;
+        }
+    }
+    if (!slot) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    slot->stamp = trajectory.stamp;
+    slot->stages = std::max(1, std::min(trajectory.stages, kStages));
+    std::copy(trajectory.time, trajectory.time + kStages, slot->time);
+    const double end = slot->time[slot->stages - 1];
+    slot->bucket_width = end > 0 ? end / kBuckets : 1;
+    for (int b = 0; b < kBuckets; b++) slot->bucket_stage[b] = trajectory.stage_at(b * slot->bucket_width);
+    slot->mass = mass;
+    slot->inertia = inertia;
+    for (int k = 0; k < kStages; k++) {
+        std::copy(trajectory.states(k), trajectory.states(k) + kCarStates, slot->x[k]);
+        std::copy(trajectory.inputs(k), trajectory.inputs(k) + kCarInputs, slot->u[k]);
+    }
+    for (int k = 0; k < kStages; k++) {
+        const double* x_end = slot->x[std::min(k + 1, kStages - 1)];
+        car_dynamics(slot->x[k], slot->u[k], mass, inertia, slot->dx_begin[k]);
+        car_dynamics(x_end, slot->u[k], mass, inertia, slot->dx_end[k]);
+    }
+
+    current_.store(slot);
+    return true;
+}
+
+const TrajectoryService::Slot* TrajectoryService::acquire() const
+{
+    for (;;) {
+        Slot* slot = current_.load();
+        if (!slot) return nullptr;
+        slot->readers.fetch_add(1);
+        /* still current after pinning: the publisher will not pick it until we release it */
+        if (current_.load() == slot) return slot;
+        release(slot);
+    }
+}
+
+double TrajectoryService::stamp() const
+{
+    const Slot* slot = acquire();
+    if (!slot) return 0;
+    double stamp = slot->stamp;
+    release(slot);
+    return stamp;
+}
+
+bool TrajectoryService::sample(double t, TrajectorySample* out, Interpolation interpolation) const
+{
+    const Slot* slot = acquire();
+    if (!slot) return false;
+
+    const int last = slot->stages - 1;
+    const double end = slot->time[last];
+    double tau = t - slot->stamp;
+    out->in_horizon = tau >= 0 && tau <= end;
+    tau = std::min(std::max(tau, 0.0), end);
+
+    /* the bucket gives the stage at its start; the few knots inside it are stepped over */
+    int b = std::min(static_cast<int>(tau / slot->bucket_width), kBuckets - 1);
+    int k = slot->bucket_stage[b];
+    while (k + 1 < last && slot->time[k + 1] <= tau) k++;
+    out->stage = k;
+    for (int i = 0; i < kCarInputs; i++) out->u[i] = slot->u[k][i];
+
+    if (last == 0) {
+        std::copy(slot->x[0], slot->x[0] + kCarStates, out->x);
+        car_dynamics(out->x, slot->u[0], slot->mass, slot->inertia, out->dx);
+        release(slot);
+        return true;
+    }
+    const double h = slot->time[k + 1] - slot->time[k];
+    const double dt = tau - slot->time[k];
+
+    if (interpolation == Interpolation::kRk4) {
+        car_rk4(slot->x[k], slot->u[k], slot->mass, slot->inertia, dt, out->x);
+        car_dynamics(out->x, slot->u[k], slot->mass, slot->inertia, out->dx);
+    } else {
+        const double s = dt / h;
+        const double s2 = s * s, s3 = s2 * s;
+        const double h00 = 2 * s3 - 3 * s2 + 1, h10 = s3 - 2 * s2 + s;
+        const double h01 = -2 * s3 + 3 * s2, h11 = s3 - s2;
+        /* derivatives of the basis with respect to time */
+        const double d00 = (6 * s2 - 6 * s) / h, d10 = 3 * s2 - 4 * s + 1;
+        const double d01 = -d00, d11 = 3 * s2 - 2 * s;
+
+        const double* x0 = slot->x[k];
+        const double* x1 = slot->x[k + 1];
+        const double* m0 = slot->dx_begin[k];
+        const double* m1 = slot->dx_end[k];
+        for (int i = 0; i < kCarStates; i++) {
+            out->x[i] = h00 * x0[i] + h10 * h * m0[i] + h01 * x1[i] + h11 * h * m1[i];
+            out->dx[i] = d00 * x0[i] + d10 * m0[i] + d01 * x1[i] + d11 * m1[i];
+        }
+    }
+
+    release(slot);
+    return true;
+}
+
+}  /* namespace mpc_planner */
@@ -0,0 +1,59 @@
+#include "mpc_planner/vehicle_model.h"
+
+#include <cmath>
+
+namespace mpc_planner {
+
+void car_dynamics(const double x[kCarStates], const double u[kCarInputs], double m, double I,
+                  double dx[kCarStates])
+{
+    dx[kX] = x[kV] * std::cos(x[kTheta]);
+    dx[kY] = x[kV] * std::sin(x[kTheta]);
+    dx[kV] = u[kForce] / m;
+    dx[kTheta] = u[kSteer] / I;
+}
+
+void car_jacobian(const double x[kCarStates], double m, double I, double A[kCarStates][kCarStates],
+                  double B[kCarStates][kCarInputs])
+{
+    const double c = std::cos(x[kTheta]), s = std::sin(x[kTheta]);
+    for (int i = 0; i < kCarStates; i++) {
+        for (int j = 0; j < kCarStates; j++) A[i][j] = 0;
+        for (int j = 0; j < kCarInputs; j++) B[i][j] = 0;
+    }
+    A[kX][kV] = c;
+    A[kX][kTheta] = -x[kV] * s;
+    A[kY][kV] = s;
+    A[kY][kTheta] = x[kV] * c;
+    B[kV][kForce] = 1 / m;
+    B[kTheta][kSteer] = 1 / I;
+}
+
+void car_rk4(const double x[kCarStates], const double u[kCarInputs], double m, double I, double h,
+             double x_next[kCarStates])
+{
+    double k1[kCarStates], k2[kCarStates], k3[kCarStates], k4[kCarStates], tmp[kCarStates];
+
+    car_dynamics(x, u, m, I, k1);
+    for (int i = 0; i < kCarStates; i++) tmp[i] = x[i] + 0.5 * h * k1[i];
+    car_dynamics(tmp, u, m, I, k2);
+    for (int i = 0; i < kCarStates; i++) tmp[i] = x[i] + 0.5 * h * k2[i];
+    car_dynamics(tmp, u, m, I, k3);
+    for (int i = 0; i < kCarStates; i++) tmp[i] = x[i] + h * k3[i];
+    car_dynamics(tmp, u, m, I, k4);
+    for (int i = 0; i < kCarStates; i++) {
+        x_next[i] = x[i] + h / 6 * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+    }
+}
+
+void model_rk4(const double x[kStates], const double u[kInputs], const double p[kStageParams], double h,
+               double x_next[kStates])
+{
+    /* the car dynamics are decoupled, so the joint RK4 step splits per car */
+    car_rk4(x, u, p[0], p[1], h, x_next);
+    for (int i = 1; i <= kObstacles; i++) {
+        car_rk4(x + kCarStates * i, u + kCarInputs * i, 1, 1, h, x_next + kCarStates * i);
+    }
+}
+
+}  /* namespace mpc_planner */
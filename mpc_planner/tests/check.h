@@ -0,0 +1,40 @@
+/*
+ * Minimal checks for the mpc_planner tests, run by ctest.
+ *
+ * CHECK and CHECK_NEAR report a failed condition with its location and go
+ * on, so one run lists every failure; main returns check_result().
+ */
+
+#ifndef MPC_PLANNER_TESTS_CHECK_H
+#define MPC_PLANNER_TESTS_CHECK_H
+
+#include <cmath>
+#include <cstdio>
+
+inline int check_failures = 0;
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            check_failures++;                                                    \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance)                                                               \
+    do {                                                                                          \
+        const double check_a = (a), check_b = (b);                                                \
+        if (!(std::fabs(check_a - check_b) <= (tolerance))) {                                     \
+            std::printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, \
+                        check_a, check_b);                                                        \
+            check_failures++;                                                                     \
+        }                                                                                         \
+    } while (0)
+
+inline int check_result()
+{
+    if (check_failures) std::printf("%d checks failed\n", check_failures);
+    return check_failures ? 1 : 0;
+}
+
+#endif  /* MPC_PLANNER_TESTS_CHECK_H */
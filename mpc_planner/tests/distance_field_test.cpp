@@ -0,0 +1,144 @@
+/*
+ * DistanceField: incremental updates against a brute-force transform of the
+ * whole grid, and the gradient of the lookup against central differences,
+ * including the half cells along the border.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "check.h"
+#include "mpc_planner/distance_field.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+/* signed distance of cell (I, J) by search over all cells, as documented in distance_field.h */
+double brute_force(const DistanceField& field, int i, int j)
+{
+    const DistanceFieldConfig& config = field.config();
+    const bool inside = field.occupied(i, j);
+    double nearest2 = -1;
+    for (int b = 0; b < config.height; b++) {
+        for (int a = 0; a < config.width; a++) {
+            if (field.occupied(a, b) == inside) continue;
+            const double d2 = double(a - i) * (a - i) + double(b - j) * (b - j);
+            if (nearest2 < 0 || d2 < nearest2) nearest2 = d2;
+        }
+    }
+    if (nearest2 < 0) return inside ? -config.max_distance : config.max_distance;
+    const double distance = std::sqrt(nearest2) * config.resolution - config.resolution / 2;
+    return std::max(std::min(inside ? -distance : distance, config.max_distance), -config.max_distance);
+}
+
+void check_against_brute_force(const DistanceField& field)
+{
+    const DistanceFieldConfig& config = field.config();
+    for (int j = 0; j < config.height; j++) {
+        for (int i = 0; i < config.width; i++) CHECK_NEAR(field.cell(i, j), brute_force(field, i, j), 1e-6);
+    }
+}
+
+DistanceFieldConfig small_config()
+{
+    DistanceFieldConfig config;
+    config.origin_x = -3;
+    config.origin_y = -2;
+    config.resolution = 0.1;
+    config.width = 60;
+    config.height = 45;
+    config.max_distance = 1.2;
+    return config;
+}
+
+void check_updates()
+{
+    DistanceField field;
+    CHECK(field.init(small_config()));
+    std::mt19937 random(5);
+    std::uniform_int_distribution<int> column(0, 59), row(0, 44), size(0, 4);
+
+    /* blobs are added and removed a few at a time, each followed by an incremental update */
+    int centres[12][2];
+    for (int round = 0; round < 12; round++) {
+        centres[round][0] = column(random);
+        centres[round][1] = row(random);
+        const int r = size(random);
+        for (int j = -r; j <= r; j++) {
+            for (int i = -r; i <= r; i++) field.set_occupied(centres[round][0] + i, centres[round][1] + j, true);
+        }
+        if (round % 3 == 2) {
+            const int* old = centres[round - 2];
+            for (int j = -2; j <= 2; j++) {
+                for (int i = -2; i <= 2; i++) field.set_occupied(old[0] + i, old[1] + j, false);
+            }
+        }
+        const long recomputed = field.update();
+        CHECK(recomputed > 0);
+        if (round % 4 == 3) check_against_brute_force(field);
+    }
+    CHECK(field.update() == 0);
+    check_against_brute_force(field);
+
+    /* a single cell only recomputes its surroundings */
+    field.set_occupied(30, 20, !field.occupied(30, 20));
+    CHECK(field.update() < 60L * 45);
+    check_against_brute_force(field);
+}
+
+void check_gradient()
+{
+    DistanceField field;
+    CHECK(field.init(small_config()));
+    for (int j = 10; j < 16; j++) {
+        for (int i = 20; i < 35; i++) field.set_occupied(i, j, true);
+    }
+    field.set_occupied(0, 0, true);
+    field.set_occupied(59, 44, true);
+    field.update();
+
+    const DistanceFieldConfig& config = field.config();
+    const double x1 = config.origin_x + config.width * config.resolution;
+    const double y1 = config.origin_y + config.height * config.resolution;
+    std::mt19937 random(6);
+    std::uniform_real_distribution<double> px(config.origin_x, x1), py(config.origin_y, y1);
+    std::uniform_real_distribution<double> border(0.001, 0.049);
+
+    for (int n = 0; n < 400; n++) {
+        double x = px(random), y = py(random);
+        /* every fourth point in a border half cell */
+        if (n % 4 == 1) x = config.origin_x + border(random);
+        if (n % 4 == 2) x = x1 - border(random);
+        if (n % 4 == 3) y = config.origin_y + border(random);
+        double grad[2];
+        field.distance(x, y, grad);
+        const double eps = 1e-7;
+        CHECK_NEAR(grad[0], (field.distance(x + eps, y) - field.distance(x - eps, y)) / (2 * eps), 1e-5);
+        CHECK_NEAR(grad[1], (field.distance(x, y + eps) - field.distance(x, y - eps)) / (2 * eps), 1e-5);
+    }
+
+    /* outside the grid */
+    double grad[2] = { 1, 1 };
+    CHECK(field.distance(config.origin_x - 1, 0, grad) == config.max_distance);
+    CHECK(grad[0] == 0 && grad[1] == 0);
+
+    /* ego_clearance fills its row of h and nabla_h */
+    const int nh = 3, row = 1;
+    const double z[kEgoStageVars] = { 0.1, 0.2, -0.37, 0.41, 0.5, 0 };
+    double h[nh] = {}, nabla_h[nh * kEgoStageVars] = {};
+    ego_clearance(field, z, row, nh, h, nabla_h);
+    CHECK(h[row] == field.distance(z[kCarInputs], z[kCarInputs + 1], grad));
+    CHECK(nabla_h[kCarInputs * nh + row] == grad[0]);
+    CHECK(nabla_h[(kCarInputs + 1) * nh + row] == grad[1]);
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_updates();
+    check_gradient();
+    return check_result();
+}
@@ -0,0 +1,148 @@
+/*
+ * Stage integrators: sensitivities against central differences and the
+ * convergence order of each method on a turning, accelerating car.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+
+#include "check.h"
+#include "mpc_planner/collocation.h"
+#include "mpc_planner/rk4_substeps.h"
+#include "mpc_planner/vehicle_model.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+const Collocation kMethods[] = { Collocation::kGaussLegendre2, Collocation::kGaussLegendre3, Collocation::kRadauIIA3 };
+
+const double kStart[kCarStates] = { 0, 0, 1, 0 };
+const double kInput[kCarInputs] = { 0.5, 1 };
+constexpr double kHorizon = 0.8;
+
+/* nabla_c of DYNAMICS at Z against central differences, relative to the largest entry */
+template <typename Dynamics>
+void check_sensitivities(Dynamics dynamics, const double z[kEgoStageVars])
+{
+    double c[kCarStates], nabla_c[kCarStates * kEgoStageVars];
+    dynamics(z, c, nabla_c);
+    double scale = 1;
+    for (double d : nabla_c) scale = std::fmax(scale, std::fabs(d));
+
+    const double eps = 1e-6;
+    for (int j = 0; j < kEgoStageVars; j++) {
+        double plus[kEgoStageVars], minus[kEgoStageVars], c_plus[kCarStates], c_minus[kCarStates];
+        std::memcpy(plus, z, sizeof(plus));
+        std::memcpy(minus, z, sizeof(minus));
+        plus[j] += eps;
+        minus[j] -= eps;
+        dynamics(plus, c_plus, nullptr);
+        dynamics(minus, c_minus, nullptr);
+        for (int r = 0; r < kCarStates; r++) {
+            CHECK_NEAR(nabla_c[j * kCarStates + r], (c_plus[r] - c_minus[r]) / (2 * eps), 1e-7 * scale);
+        }
+    }
+}
+
+/* largest error of STEPS steps of METHOD over kHorizon against REFERENCE */
+double collocation_error(Collocation method, int steps, const double reference[kCarStates])
+{
+    CollocationConfig config;
+    config.method = method;
+    double x[kCarStates], x_next[kCarStates];
+    std::memcpy(x, kStart, sizeof(x));
+    for (int k = 0; k < steps; k++) {
+        CHECK(car_collocation(config, x, kInput, kMass, kInertia, kHorizon / steps, x_next));
+        std::memcpy(x, x_next, sizeof(x));
+    }
+    double error = 0;
+    for (int r = 0; r < kCarStates; r++) error = std::fmax(error, std::fabs(x[r] - reference[r]));
+    return error;
+}
+
+void check_collocation()
+{
+    const double z[kEgoStageVars] = { 0.7, -0.4, 0.3, -0.2, 0.8, 0.6 };
+    const double p[kStageParams] = { kMass, kInertia };
+    for (Collocation method : kMethods) {
+        CollocationConfig config;
+        config.method = method;
+        check_sensitivities([&](const double* zz, double* c, double* nabla_c) {
+            CHECK(ego_collocation(config, zz, p, 0.4, c, nabla_c));
+        }, z);
+    }
+
+    /* observed order from steps of 0.4 s and 0.2 s, against a fine RK4 solution */
+    double reference[kCarStates];
+    car_rk4_substeps(kStart, kInput, kMass, kInertia, kHorizon, 4096, reference);
+    for (Collocation method : kMethods) {
+        const double coarse = collocation_error(method, 2, reference);
+        const double fine = collocation_error(method, 4, reference);
+        CHECK_NEAR(std::log2(coarse / fine), collocation_order(method), 0.3);
+    }
+
+    /* 3-point Gauss-Legendre at 0.4 s is more accurate than RK4 at 0.1 s (about 14 times here) */
+    double rk4[kCarStates];
+    car_rk4_substeps(kStart, kInput, kMass, kInertia, kHorizon, 8, rk4);
+    double rk4_error = 0;
+    for (int r = 0; r < kCarStates; r++) rk4_error = std::fmax(rk4_error, std::fabs(rk4[r] - reference[r]));
+    CHECK(collocation_error(Collocation::kGaussLegendre3, 2, reference) < rk4_error);
+
+    /* the full model integrates each car on its own */
+    const double x[kStates] = { -1.5, 0, 0.5, kPi / 2, -1, 1.11, 0.1, kPi / 4, -2, 0, 0.5, kPi / 2 };
+    const double u[kInputs] = { 0.3, 0.2, 0, 0, -0.1, 0.1 };
+    CollocationConfig config;
+    double x_next[kStates], car_next[kCarStates];
+    CHECK(model_collocation(config, x, u, p, kStepSize, x_next));
+    for (int i = 0; i <= kObstacles; i++) {
+        const double m = i ? 1 : p[0], I = i ? 1 : p[1];
+        car_collocation(config, x + kCarStates * i, u + kCarInputs * i, m, I, kStepSize, car_next);
+        for (int r = 0; r < kCarStates; r++) CHECK(x_next[kCarStates * i + r] == car_next[r]);
+    }
+}
+
+void check_rk4_substeps()
+{
+    /* one substep is car_rk4 and model_rk4, bit for bit */
+    double x_next[kCarStates], reference[kCarStates];
+    car_rk4_substeps(kStart, kInput, kMass, kInertia, kStepSize, 1, x_next);
+    car_rk4(kStart, kInput, kMass, kInertia, kStepSize, reference);
+    CHECK(std::memcmp(x_next, reference, sizeof(x_next)) == 0);
+
+    const double x[kStates] = { -1.5, 0, 0.5, kPi / 2, -1, 1.11, 0.1, kPi / 4, -2, 0, 0.5, kPi / 2 };
+    const double u[kInputs] = { 0.3, 0.2, 0, 0, -0.1, 0.1 };
+    const double p[kStageParams] = { kMass, kInertia };
+    double model_next[kStates], model_reference[kStates];
+    model_rk4_substeps(x, u, p, kStepSize, 1, model_next);
+    model_rk4(x, u, p, kStepSize, model_reference);
+    CHECK(std::memcmp(model_next, model_reference, sizeof(model_next)) == 0);
+
+    /* the forward-mode Jacobian is the derivative of the discrete map */
+    const double z[kEgoStageVars] = { 0.7, -0.4, 0.3, -0.2, 0.8, 0.6 };
+    for (int substeps : { 1, 3 }) {
+        check_sensitivities([&](const double* zz, double* c, double* nabla_c) {
+            ego_rk4_substeps(zz, p, 0.3, substeps, c, nabla_c);
+        }, z);
+    }
+
+    /* M substeps of h/M are M steps of car_rk4 */
+    double state[kCarStates], next[kCarStates];
+    std::memcpy(state, kStart, sizeof(state));
+    for (int k = 0; k < 3; k++) {
+        car_rk4(state, kInput, kMass, kInertia, 0.1, next);
+        std::memcpy(state, next, sizeof(state));
+    }
+    car_rk4_substeps(kStart, kInput, kMass, kInertia, 0.3, 3, x_next);
+    for (int r = 0; r < kCarStates; r++) CHECK_NEAR(x_next[r], state[r], 1e-15);
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_collocation();
+    check_rk4_substeps();
+    return check_result();
+}
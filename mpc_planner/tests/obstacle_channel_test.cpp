@@ -0,0 +1,74 @@
+/*
+ * write_obstacle_states through an ObstacleChannel: the obstacle states of the
+ * state estimate stand until perception publishes, the published set
+ * overrides them from then on.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "check.h"
+#include "mpc_planner/obstacle_channel.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+const double kEstimate[kStates] = { -1.5, 0, 0.5, kPi / 2, -1, 1.11, 0.1, kPi / 4, -2, 0, 0.5, kPi / 2 };
+
+void check_before_publish()
+{
+    ObstacleChannel channel;
+    ObstacleSlots slots;
+    double xinit[kStates];
+    std::copy(kEstimate, kEstimate + kStates, xinit);
+
+    /* the working set is not seen until it is published */
+    const double x[kCarStates] = { 1, 2, 0.3, 0 };
+    channel.update(7, x);
+    for (int tick = 0; tick < 3; tick++) {
+        const ObstacleSet& set = channel.snapshot();
+        CHECK(!set.published);
+        write_obstacle_states(set, 0.1 * tick + 1, &slots, xinit);
+        for (int i = 0; i < kStates; i++) CHECK(xinit[i] == kEstimate[i]);
+    }
+}
+
+void check_after_publish()
+{
+    ObstacleChannel channel;
+    ObstacleSlots slots;
+    double xinit[kStates];
+
+    /* one obstacle: predicted to the solve stamp in its slot, the other slot parked */
+    const double x[kCarStates] = { 1, 2, 0.3, 0 };
+    channel.update(7, x);
+    channel.publish(1.0);
+    std::copy(kEstimate, kEstimate + kStates, xinit);
+    write_obstacle_states(channel.snapshot(), 1.5, &slots, xinit);
+    for (int i = 0; i < kCarStates; i++) CHECK(xinit[i] == kEstimate[i]);
+    CHECK_NEAR(xinit[kCarStates + kX], 1.15, 1e-12);
+    CHECK_NEAR(xinit[kCarStates + kY], 2, 1e-12);
+    CHECK_NEAR(xinit[kCarStates + kV], 0.3, 1e-12);
+    CHECK(slots.id(0) == 7);
+    for (int i = 0; i < kCarStates; i++) CHECK(xinit[2 * kCarStates + i] == kParkedObstacles[1][i]);
+
+    /* an empty published set means no obstacles: both slots parked */
+    channel.remove(7);
+    channel.publish(2.0);
+    std::copy(kEstimate, kEstimate + kStates, xinit);
+    write_obstacle_states(channel.snapshot(), 2.0, &slots, xinit);
+    for (int slot = 0; slot < kObstacles; slot++) {
+        CHECK(slots.id(slot) == -1);
+        for (int i = 0; i < kCarStates; i++) CHECK(xinit[kCarStates * (slot + 1) + i] == kParkedObstacles[slot][i]);
+    }
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_before_publish();
+    check_after_publish();
+    return check_result();
+}
@@ -0,0 +1,122 @@
+/*
+ * ObstacleManager against a brute-force nearest search, and with coordinates
+ * perception should never send but might.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+
+#include "check.h"
+#include "mpc_planner/obstacle_manager.h"
+#include "mpc_planner/obstacle_predictor.h"
+
+using namespace mpc_planner;
+
+static void check_brute_force()
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> position(-6, 6), speed(0, 1), heading(-kPi, kPi);
+
+    ObstacleSet set;
+    set.count = 60;
+    for (int i = 0; i < set.count; i++) {
+        set.obstacles[i].id = i;
+        double* x = set.obstacles[i].x;
+        x[kX] = position(random);
+        x[kY] = position(random);
+        x[kV] = speed(random);
+        x[kTheta] = heading(random);
+    }
+
+    ObstacleManagerConfig config;
+    std::unique_ptr<ObstacleManager> manager(new ObstacleManager(config));
+    manager->update(set, 0);
+
+    double ego_xy[kStages][2];
+    for (int k = 0; k < kStages; k++) {
+        ego_xy[k][0] = position(random) / 2;
+        ego_xy[k][1] = position(random) / 2;
+    }
+    std::unique_ptr<double[]> all_parameters(new double[kStages * kEgoStageParams]);
+    manager->write_parameters(ego_xy, all_parameters.get());
+    CHECK(manager->candidates() < static_cast<long>(kStages) * set.count);
+
+    for (int k = 0; k < kStages; k++) {
+        /* nearest kObstacleSlots within range */
+        int order[kMaxTrackedObstacles];
+        double distance2[kMaxTrackedObstacles];
+        for (int i = 0; i < set.count; i++) {
+            const double* x = set.obstacles[i].x;
+            const double dx = x[kX] + x[kV] * std::cos(x[kTheta]) * kStepSize * k - ego_xy[k][0];
+            const double dy = x[kY] + x[kV] * std::sin(x[kTheta]) * kStepSize * k - ego_xy[k][1];
+            distance2[i] = dx * dx + dy * dy;
+            order[i] = i;
+        }
+        std::sort(order, order + set.count, [&](int a, int b) { return distance2[a] < distance2[b]; });
+        int expected[kObstacleSlots], selected[kObstacleSlots];
+        for (int s = 0; s < kObstacleSlots; s++) {
+            expected[s] = distance2[order[s]] <= config.range * config.range ? order[s] : -1;
+            selected[s] = manager->active(k, s);
+        }
+        std::sort(expected, expected + kObstacleSlots);
+        std::sort(selected, selected + kObstacleSlots);
+        for (int s = 0; s < kObstacleSlots; s++) CHECK(selected[s] == expected[s]);
+
+        /* the parameters hold the selected poses, parked slots far away */
+        double* params = ego_stage_params(all_parameters.get(), k);
+        for (int s = 0; s < kObstacleSlots; s++) {
+            const int i = manager->active(k, s);
+            const double* pose = obstacle_pose(params, s);
+            if (i < 0) {
+                CHECK(pose[kPoseX] == kParkedPosition);
+            } else {
+                const double* x = set.obstacles[i].x;
+                CHECK_NEAR(pose[kPoseX], x[kX] + x[kV] * std::cos(x[kTheta]) * kStepSize * k, 1e-9);
+            }
+        }
+    }
+}
+
+static void check_bad_coordinates()
+{
+    const double bad[] = { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity(),
+                           -std::numeric_limits<double>::infinity(), 1e300, -1e300 };
+    ObstacleSet set;
+    set.count = 0;
+    for (double value : bad) {
+        ObstacleState& obstacle = set.obstacles[set.count];
+        obstacle.id = set.count++;
+        obstacle.x[kX] = value;
+        obstacle.x[kY] = 0;
+        obstacle.x[kV] = 0;
+        obstacle.x[kTheta] = 0;
+    }
+    /* one regular obstacle next to the ego car */
+    ObstacleState& near = set.obstacles[set.count];
+    near.id = set.count++;
+    near.x[kX] = 0.5;
+
+    std::unique_ptr<ObstacleManager> manager(new ObstacleManager());
+    manager->update(set, 0);
+    double ego_xy[kStages][2] = {};
+    std::unique_ptr<double[]> all_parameters(new double[kStages * kEgoStageParams]);
+    manager->write_parameters(ego_xy, all_parameters.get());
+    for (int k = 0; k < kStages; k++) {
+        int found = 0;
+        for (int s = 0; s < kObstacleSlots; s++) {
+            CHECK(manager->active(k, s) < 0 || manager->active(k, s) == near.id);
+            found += manager->active(k, s) == near.id;
+        }
+        CHECK(found == 1);
+    }
+}
+
+int main()
+{
+    check_brute_force();
+    check_bad_coordinates();
+    return check_result();
+}
@@ -0,0 +1,197 @@
+/*
+ * OBCA rows: the Jacobian of obca_constraints against central differences,
+ * and the separation certified by separating_duals against the footprints'
+ * vertices.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include "check.h"
+#include "mpc_planner/polygon_avoidance.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+void vertices(const double pose[kPoseParams], const Footprint& footprint, double out[4][2])
+{
+    const double c = std::cos(pose[kPoseTheta]), s = std::sin(pose[kPoseTheta]);
+    const double corners[4][2] = { { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+    for (int k = 0; k < 4; k++) {
+        const double a = corners[k][0] * footprint.half_length, b = corners[k][1] * footprint.half_width;
+        out[k][0] = pose[kPoseX] + c * a - s * b;
+        out[k][1] = pose[kPoseY] + s * a + c * b;
+    }
+}
+
+/* largest gap between the vertex projections along the face normals of either box, as the separating axis test */
+double face_separation(const double ego[kPoseParams], const double obstacle[kPoseParams])
+{
+    double e[4][2], o[4][2];
+    vertices(ego, kEgoFootprint, e);
+    vertices(obstacle, kObstacleFootprint, o);
+    double best = -kInf;
+    for (int box = 0; box < 2; box++) {
+        const double* pose = box ? ego : obstacle;
+        const double(*own)[2] = box ? e : o;
+        const double(*other)[2] = box ? o : e;
+        for (int face = 0; face < 4; face++) {
+            const double angle = pose[kPoseTheta] + face * kPi / 2;
+            const double u[2] = { std::cos(angle), std::sin(angle) };
+            double top = -kInf, bottom = kInf;
+            for (int k = 0; k < 4; k++) {
+                top = std::max(top, u[0] * own[k][0] + u[1] * own[k][1]);
+                bottom = std::min(bottom, u[0] * other[k][0] + u[1] * other[k][1]);
+            }
+            best = std::max(best, bottom - top);
+        }
+    }
+    return best;
+}
+
+/* Euclidean distance of two disjoint boxes: the closest pair includes a vertex */
+double box_distance(const double ego[kPoseParams], const double obstacle[kPoseParams])
+{
+    double e[4][2], o[4][2];
+    vertices(ego, kEgoFootprint, e);
+    vertices(obstacle, kObstacleFootprint, o);
+    double best = kInf;
+    for (int box = 0; box < 2; box++) {
+        const double(*points)[2] = box ? e : o;
+        const double(*edges)[2] = box ? o : e;
+        for (int k = 0; k < 4; k++) {
+            for (int m = 0; m < 4; m++) {
+                const double* a = edges[m];
+                const double* b = edges[(m + 1) % 4];
+                const double dx = b[0] - a[0], dy = b[1] - a[1];
+                double t = ((points[k][0] - a[0]) * dx + (points[k][1] - a[1]) * dy) / (dx * dx + dy * dy);
+                t = std::min(std::max(t, 0.0), 1.0);
+                best = std::min(best, std::hypot(points[k][0] - a[0] - t * dx, points[k][1] - a[1] - t * dy));
+            }
+        }
+    }
+    return best;
+}
+
+void check_jacobian()
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> uniform(-1, 1), positive(0, 1);
+    for (int n = 0; n < 20; n++) {
+        double z[kObcaStageVars], p[kEgoStageParams] = { kMass, kInertia };
+        for (int i = 0; i < kEgoStageVars; i++) z[i] = uniform(random);
+        for (int i = kEgoStageVars; i < kObcaStageVars; i++) z[i] = positive(random);
+        for (int i = kParamObstacles; i < kEgoStageParams; i++) p[i] = 2 * uniform(random);
+
+        double h[kObcaIneqs], nabla_h[kObcaIneqs * kObcaStageVars] = {};
+        obca_constraints(z, p, h, nabla_h);
+        const double eps = 1e-6;
+        for (int j = 0; j < kObcaStageVars; j++) {
+            double plus[kObcaStageVars], minus[kObcaStageVars], h_plus[kObcaIneqs], h_minus[kObcaIneqs];
+            std::copy(z, z + kObcaStageVars, plus);
+            std::copy(z, z + kObcaStageVars, minus);
+            plus[j] += eps;
+            minus[j] -= eps;
+            obca_constraints(plus, p, h_plus, nullptr);
+            obca_constraints(minus, p, h_minus, nullptr);
+            for (int r = 0; r < kObcaIneqs; r++) {
+                CHECK_NEAR(nabla_h[j * kObcaIneqs + r], (h_plus[r] - h_minus[r]) / (2 * eps), 1e-7);
+            }
+        }
+    }
+}
+
+void check_separating_duals()
+{
+    std::mt19937 random(8);
+    std::uniform_real_distribution<double> position(-1.5, 1.5), heading(-kPi, kPi);
+    int separated = 0, overlapping = 0;
+    for (int n = 0; n < 2000; n++) {
+        const double ego[kPoseParams] = { position(random), position(random), heading(random) };
+        const double obstacle[kPoseParams] = { position(random), position(random), heading(random) };
+        double lambda[kObcaLambdas], mu[kObcaMus];
+        const double separation = separating_duals(ego, kEgoFootprint, obstacle, kObstacleFootprint, lambda, mu);
+        const double expected = face_separation(ego, obstacle);
+        CHECK_NEAR(separation, expected, 1e-12);
+        if (expected < 0) {
+            overlapping++;
+            continue;
+        }
+        separated++;
+        /* a lower bound of the distance, and the distance where a face is closest */
+        const double distance = box_distance(ego, obstacle);
+        CHECK(separation <= distance + 1e-12);
+
+        /* the duals satisfy the rows of a stage at these poses and certify the separation */
+        double z[kObcaStageVars] = {}, p[kEgoStageParams] = { kMass, kInertia };
+        z[kCarInputs + kX] = ego[kPoseX];
+        z[kCarInputs + kY] = ego[kPoseY];
+        z[kCarInputs + kTheta] = ego[kPoseTheta];
+        for (int slot = 0; slot < kObstacleSlots; slot++) {
+            std::copy(obstacle, obstacle + kPoseParams, p + kParamObstacles + kPoseParams * slot);
+            std::copy(lambda, lambda + kObcaLambdas, z + obca_duals(slot));
+            std::copy(mu, mu + kObcaMus, z + obca_duals(slot) + kObcaLambdas);
+        }
+        double h[kObcaIneqs];
+        obca_constraints(z, p, h, nullptr);
+        for (int r = 0; r < kObcaIneqs; r++) {
+            const int row = r % kObcaRows;
+            if (row == kObcaSeparation) {
+                CHECK_NEAR(h[r], separation, 1e-12);
+            } else {
+                CHECK(h[r] >= kObcaLower[row] - 1e-12 && h[r] <= kObcaUpper[row] + 1e-12);
+            }
+        }
+    }
+    CHECK(separated > 100 && overlapping > 100);
+
+    /* face to face, the separation is the distance */
+    const double ego[kPoseParams] = { 0, 0, 0.3 };
+    const double ahead[kPoseParams] = { 0.9 * std::cos(0.3), 0.9 * std::sin(0.3), 0.3 };
+    const double beside[kPoseParams] = { -0.4 * std::sin(0.3), 0.4 * std::cos(0.3), 0.3 + kPi };
+    double lambda[kObcaLambdas], mu[kObcaMus];
+    CHECK_NEAR(separating_duals(ego, kEgoFootprint, ahead, kObstacleFootprint, lambda, mu), 0.4, 1e-12);
+    CHECK_NEAR(separating_duals(ego, kEgoFootprint, beside, kObstacleFootprint, lambda, mu), 0.16, 1e-12);
+    CHECK_NEAR(box_distance(ego, ahead), 0.4, 1e-12);
+}
+
+void check_warm_start()
+{
+    std::unique_ptr<double[]> x0(new double[kStages * kObcaStageVars]());
+    std::unique_ptr<double[]> all_parameters(new double[kStages * kEgoStageParams]);
+    for (int k = 0; k < kStages; k++) {
+        double* z = x0.get() + kObcaStageVars * k;
+        z[kCarInputs + kX] = -1.5 + 0.03 * k;
+        z[kCarInputs + kTheta] = 0.01 * k;
+        double* p = all_parameters.get() + kEgoStageParams * k;
+        p[0] = kMass;
+        p[1] = kInertia;
+        const double obstacles[kObstacleSlots][kPoseParams] = { { 1, 0.8, 0.5 }, { -1, -0.9, -kPi / 2 } };
+        for (int slot = 0; slot < kObstacleSlots; slot++) {
+            std::copy(obstacles[slot], obstacles[slot] + kPoseParams, p + kParamObstacles + kPoseParams * slot);
+        }
+    }
+    warm_start_duals(x0.get(), all_parameters.get());
+    for (int k = 0; k < kStages; k++) {
+        const double* z = x0.get() + kObcaStageVars * k;
+        double h[kObcaIneqs];
+        obca_constraints(z, all_parameters.get() + kEgoStageParams * k, h, nullptr);
+        for (int r = 0; r < kObcaIneqs; r++) {
+            const int row = r % kObcaRows;
+            CHECK(h[r] >= kObcaLower[row] - 1e-12 && h[r] <= kObcaUpper[row] + 1e-12);
+        }
+    }
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_jacobian();
+    check_separating_duals();
+    check_warm_start();
+    return check_result();
+}
@@ -0,0 +1,195 @@
+/*
+ * ReferencePath on paths with a closed form: a circle, through the periodic
+ * spline, also as a road spanning a 1 km square, and a straight line, through
+ * the natural one and the extrapolation past its ends. road_frenet against
+ * central differences.
+ */
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "check.h"
+#include "mpc_planner/reference_path.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+constexpr double kRadius = 1.5;
+
+/* a spline through 64 points of the circle deviates from it by about this much; curvature by 1e-3 */
+constexpr double kCircleError = 2e-5;
+
+void check_circle()
+{
+    const int n = 64;
+    std::vector<double> x(n), y(n);
+    for (int i = 0; i < n; i++) {
+        x[i] = kRadius * std::cos(2 * kPi * i / n);
+        y[i] = kRadius * std::sin(2 * kPi * i / n);
+    }
+    ReferencePathConfig config;
+    config.closed = true;
+    ReferencePath path;
+    CHECK(path.build(config, x.data(), y.data(), n));
+    CHECK_NEAR(path.length(), 2 * kPi * kRadius, kCircleError);
+
+    for (int i = 0; i < 50; i++) {
+        const double s = path.length() * i / 50;
+        const double phi = s / kRadius;
+        PathPoint point = path.point(s);
+        CHECK_NEAR(point.x, kRadius * std::cos(phi), kCircleError);
+        CHECK_NEAR(point.y, kRadius * std::sin(phi), kCircleError);
+        CHECK_NEAR(std::remainder(point.theta - (phi + kPi / 2), 2 * kPi), 0, kCircleError);
+        CHECK_NEAR(point.kappa, 1 / kRadius, 1e-3);
+    }
+    /* wrapped on a closed path */
+    CHECK_NEAR(path.point(-0.5).x, path.point(path.length() - 0.5).x, 1e-9);
+    CHECK_NEAR(path.point(path.length() + 0.5).y, path.point(0.5).y, 1e-9);
+
+    /* s = R phi, d = R - r, grad s = R / r (-sin, cos), grad d = -(cos, sin) */
+    std::mt19937 random(3);
+    std::uniform_real_distribution<double> angle(0, 2 * kPi), radius(kRadius - 0.9, kRadius + 0.9);
+    for (int i = 0; i < 200; i++) {
+        const double phi = angle(random), r = radius(random);
+        FrenetPoint f;
+        CHECK(path.project(r * std::cos(phi), r * std::sin(phi), &f));
+        CHECK_NEAR(std::remainder(f.s - kRadius * phi, path.length()), 0, kCircleError);
+        CHECK_NEAR(f.d, kRadius - r, kCircleError);
+        /* ds depends on the curvature */
+        CHECK_NEAR(f.ds[0], -kRadius / r * std::sin(phi), 3e-3);
+        CHECK_NEAR(f.ds[1], kRadius / r * std::cos(phi), 3e-3);
+        CHECK_NEAR(f.dd[0], -std::cos(phi), kCircleError);
+        CHECK_NEAR(f.dd[1], -std::sin(phi), kCircleError);
+    }
+}
+
+/*
+ * A road spanning a 1 km square: the grid only covers the band along it, the
+ * projection holds there and positions off the band fall back to the search.
+ */
+void check_long_road()
+{
+    const double radius = 500;
+    const int n = 256;
+    std::vector<double> x(n), y(n);
+    for (int i = 0; i < n; i++) {
+        x[i] = radius * std::cos(2 * kPi * i / n);
+        y[i] = radius * std::sin(2 * kPi * i / n);
+    }
+    ReferencePathConfig config;
+    config.closed = true;
+    config.margin = 1;
+    ReferencePath path;
+    CHECK(path.build(config, x.data(), y.data(), n));
+    CHECK_NEAR(path.length(), 2 * kPi * radius, 1e-3);
+
+    std::mt19937 random(4);
+    std::uniform_real_distribution<double> angle(0, 2 * kPi), offset(-0.9, 0.9);
+    for (int i = 0; i < 200; i++) {
+        const double phi = angle(random), r = radius + offset(random);
+        FrenetPoint f;
+        CHECK(path.project(r * std::cos(phi), r * std::sin(phi), &f));
+        CHECK_NEAR(std::remainder(f.s - radius * phi, path.length()), 0, 1e-3);
+        CHECK_NEAR(f.d, radius - r, 1e-4);
+    }
+    FrenetPoint f;
+    CHECK(!path.project(0, 0, &f));
+    CHECK_NEAR(f.d, radius, 1e-3);
+    CHECK(!path.project(1e300, -1e300, &f));
+
+    /* a grid beyond max_grid_cells fails the build */
+    config.max_grid_cells = 1 << 16;
+    CHECK(!path.build(config, x.data(), y.data(), n));
+    CHECK(path.empty());
+}
+
+void check_line()
+{
+    const double x[] = { 0, 1, 2, 3 }, y[] = { 0, 0, 0, 0 };
+    ReferencePath path;
+    CHECK(path.build(ReferencePathConfig(), x, y, 4));
+    CHECK_NEAR(path.length(), 3, 1e-12);
+
+    /* inside, and past both ends along the end tangents */
+    const double positions[][2] = { { 1.3, 0.4 }, { -1, 0.5 }, { 4.5, -0.3 }, { 2.9, -1.2 } };
+    for (const auto& position : positions) {
+        FrenetPoint f;
+        path.project(position[0], position[1], &f);
+        CHECK_NEAR(f.s, position[0], 1e-9);
+        CHECK_NEAR(f.d, position[1], 1e-9);
+        CHECK_NEAR(f.ds[0], 1, 1e-9);
+        CHECK_NEAR(f.ds[1], 0, 1e-9);
+        CHECK_NEAR(f.dd[0], 0, 1e-9);
+        CHECK_NEAR(f.dd[1], 1, 1e-9);
+    }
+    CHECK_NEAR(path.point(-1).x, 0, 1e-12);
+    CHECK_NEAR(path.point(5).x, 3, 1e-12);
+}
+
+void check_road_frenet()
+{
+    const int n = 64;
+    std::vector<double> x(n), y(n);
+    for (int i = 0; i < n; i++) {
+        x[i] = kRadius * std::cos(2 * kPi * i / n);
+        y[i] = kRadius * std::sin(2 * kPi * i / n);
+    }
+    ReferencePathConfig config;
+    config.closed = true;
+    config.left_width = 0.4;
+    config.right_width = 0.6;
+    ReferencePath path;
+    CHECK(path.build(config, x.data(), y.data(), n));
+
+    double s[kStages];
+    for (int k = 0; k < kStages; k++) s[k] = 0.1 * k;
+    std::unique_ptr<double[]> all_parameters(new double[kStages * kRoadStageParams]);
+    write_road_params(path, s, all_parameters.get());
+
+    std::mt19937 random(4);
+    std::uniform_real_distribution<double> offset(-0.5, 0.5);
+    for (int k = 0; k < kStages; k += 7) {
+        const double* p = all_parameters.get() + kRoadStageParams * k;
+        const PathPoint point = path.point(s[k]);
+        CHECK(p[0] == kMass && p[1] == kInertia);
+        CHECK(p[kParamRoad + kRoadX] == point.x && p[kParamRoad + kRoadY] == point.y);
+        CHECK(p[kParamRoad + kRoadTheta] == point.theta && p[kParamRoad + kRoadKappa] == point.kappa);
+        CHECK(p[kParamRoad + kRoadLeft] == 0.4 && p[kParamRoad + kRoadRight] == 0.6);
+
+        /* zero at the road point */
+        double s0, d0;
+        road_frenet(p, point.x, point.y, &s0, &d0, nullptr, nullptr);
+        CHECK_NEAR(s0, 0, 1e-12);
+        CHECK_NEAR(d0, 0, 1e-12);
+
+        for (int i = 0; i < 5; i++) {
+            const double px = point.x + offset(random), py = point.y + offset(random);
+            double ds[2], dd[2];
+            road_frenet(p, px, py, nullptr, nullptr, ds, dd);
+            const double eps = 1e-6;
+            double sp, sm, dp, dm;
+            road_frenet(p, px + eps, py, &sp, &dp, nullptr, nullptr);
+            road_frenet(p, px - eps, py, &sm, &dm, nullptr, nullptr);
+            CHECK_NEAR(ds[0], (sp - sm) / (2 * eps), 1e-8);
+            CHECK_NEAR(dd[0], (dp - dm) / (2 * eps), 1e-8);
+            road_frenet(p, px, py + eps, &sp, &dp, nullptr, nullptr);
+            road_frenet(p, px, py - eps, &sm, &dm, nullptr, nullptr);
+            CHECK_NEAR(ds[1], (sp - sm) / (2 * eps), 1e-8);
+            CHECK_NEAR(dd[1], (dp - dm) / (2 * eps), 1e-8);
+        }
+    }
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_circle();
+    check_long_road();
+    check_line();
+    check_road_frenet();
+    return check_result();
+}
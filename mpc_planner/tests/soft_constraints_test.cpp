@@ -0,0 +1,128 @@
+/*
+ * Soft rows: the derivatives of soft_penalty, the slope l1 of any
+ * violation, and the gradient and Gauss-Newton Hessian of soften against
+ * central differences.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "check.h"
+#include "mpc_planner/problem.h"
+#include "mpc_planner/soft_constraints.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+constexpr double kL1 = 100;
+constexpr double kL2 = 10;
+constexpr double kSmoothing = 0.1;
+
+void check_penalty()
+{
+    const double eps = 1e-7;
+    for (int n = -300; n <= 300; n++) {
+        const double v = 0.00137 * n;
+        double d1, d2;
+        const double penalty = soft_penalty(v, kL1, kL2, kSmoothing, &d1, &d2);
+        double d1_plus, d1_minus;
+        const double plus = soft_penalty(v + eps, kL1, kL2, kSmoothing, &d1_plus);
+        const double minus = soft_penalty(v - eps, kL1, kL2, kSmoothing, &d1_minus);
+        /* the curvature jumps at the ends of the parabola and at the bound */
+        if (std::fabs(v) > 2 * eps && std::fabs(v + kSmoothing) > 2 * eps) {
+            CHECK_NEAR(d1, (plus - minus) / (2 * eps), 1e-5);
+            CHECK_NEAR(d2, (d1_plus - d1_minus) / (2 * eps), 1e-5);
+        }
+
+        if (v <= -kSmoothing) {
+            CHECK(penalty == 0 && d1 == 0 && d2 == 0);
+        } else if (v >= 0) {
+            /* exact: the full slope l1 from the bound on */
+            CHECK_NEAR(penalty, kL1 * (v + kSmoothing / 2) + kL2 * v * v / 2, 1e-12);
+            CHECK_NEAR(d1, kL1 + kL2 * v, 1e-12);
+        } else {
+            CHECK(penalty > 0 && d1 > 0 && d1 < kL1);
+        }
+    }
+    CHECK(soft_penalty(0, kL1, kL2, 0) == 0);
+    CHECK(soft_penalty(0.2, kL1, kL2, 0) == kL1 * 0.2 + kL2 * 0.02);
+}
+
+/* rows h = A z + b, with a lower, an upper, a two-sided and an unbounded row */
+constexpr int kRows = 4;
+constexpr int kVars = 3;
+constexpr double kHl[kRows] = { 0, -kInf, -0.5, -kInf };
+constexpr double kHu[kRows] = { kInf, 0.3, 0.5, kInf };
+constexpr SoftRow kSoftRows[kRows] = { { 0, kL1, kL2 }, { 1, kL1, 0 }, { 2, 2 * kL1, kL2 }, { 3, kL1, kL2 } };
+
+struct Rows {
+    double A[kRows][kVars];
+    double b[kRows];
+
+    double objective(const double z[kVars], double* nabla_f, double* H) const
+    {
+        double h[kRows], nabla_h[kRows * kVars];
+        for (int r = 0; r < kRows; r++) {
+            h[r] = b[r];
+            for (int j = 0; j < kVars; j++) {
+                h[r] += A[r][j] * z[j];
+                nabla_h[j * kRows + r] = A[r][j];
+            }
+        }
+        double f = 0;
+        soften(kSoftRows, kRows, kRows, kVars, h, nabla_h, kHl, kHu, kSmoothing, &f, nabla_f, H);
+        return f;
+    }
+};
+
+void check_soften()
+{
+    std::mt19937 random(5);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    const double eps = 1e-7;
+    for (int n = 0; n < 200; n++) {
+        Rows rows;
+        for (int r = 0; r < kRows; r++) {
+            for (int j = 0; j < kVars; j++) rows.A[r][j] = uniform(random);
+            rows.b[r] = 0.3 * uniform(random);
+        }
+        double z[kVars];
+        for (int j = 0; j < kVars; j++) z[j] = 0.3 * uniform(random);
+
+        double nabla_f[kVars] = {}, H[kVars * kVars] = {};
+        rows.objective(z, nabla_f, H);
+        for (int j = 0; j < kVars; j++) {
+            double plus[kVars], minus[kVars];
+            std::copy(z, z + kVars, plus);
+            std::copy(z, z + kVars, minus);
+            plus[j] += eps;
+            minus[j] -= eps;
+            double g_plus[kVars] = {}, g_minus[kVars] = {};
+            const double f_plus = rows.objective(plus, g_plus, nullptr);
+            const double f_minus = rows.objective(minus, g_minus, nullptr);
+            CHECK_NEAR(nabla_f[j], (f_plus - f_minus) / (2 * eps), 1e-5);
+            /* h is linear, so the Gauss-Newton term is the Hessian */
+            for (int i = 0; i < kVars; i++) {
+                CHECK_NEAR(H[j * kVars + i], (g_plus[i] - g_minus[i]) / (2 * eps), 1e-4);
+                CHECK_NEAR(H[j * kVars + i], H[i * kVars + j], 1e-12);
+            }
+        }
+    }
+
+    /* soft_violation reports the largest violation, 0 inside the bounds */
+    const double inside[kRows] = { 0.1, 0.2, 0, 5 };
+    const double outside[kRows] = { -0.2, 0.4, 0.6, 5 };
+    CHECK(soft_violation(kSoftRows, kRows, inside, kHl, kHu) == 0);
+    CHECK_NEAR(soft_violation(kSoftRows, kRows, outside, kHl, kHu), 0.2, 1e-15);
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_penalty();
+    check_soften();
+    return check_result();
+}
@@ -0,0 +1,148 @@
+/*
+ * SolveRecorder and SolveLogReader: a log reads back exactly, and a
+ * corrupt frame header, a corrupt payload or a cut off end lose only the
+ * records up to the next keyframe.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "mpc_planner/solve_recorder.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+constexpr int kRecords = 30;
+constexpr int kKeyframeInterval = 5;
+constexpr size_t kLogHeaderBytes = 16;
+constexpr size_t kFrameHeaderBytes = 16;
+const char* const kPath = "solve_recorder_test.log";
+
+/* record I, slowly changing as consecutive solves do */
+void make_record(int i, SolveRecord* record)
+{
+    std::memset(record, 0, sizeof(*record));
+    record->stamp = 0.1 * i;
+    record->deadline = 0.05;
+    record->exitflag = i % 3 ? 1 : -6;
+    record->guess = i % 4;
+    for (int j = 0; j < 12; j++) record->params.xinit[j] = std::sin(0.01 * i + j);
+    for (int j = 0; j < 1530; j++) record->params.x0[j] = std::cos(0.01 * i + 0.1 * j);
+    for (int j = 0; j < 170; j++) record->params.all_parameters[j] = j % 7;
+    for (int j = 0; j < 18; j++) record->output.x01[j] = i + j;
+    record->info.it = i;
+}
+
+std::vector<char> write_log()
+{
+    std::remove(kPath);
+    {
+        SolveRecorderConfig config;
+        config.path = kPath;
+        config.slots = 2 * kRecords;
+        config.keyframe_interval = kKeyframeInterval;
+        SolveRecorder recorder(config);
+        CHECK(recorder.ok());
+        std::unique_ptr<SolveRecord> record(new SolveRecord);
+        for (int i = 0; i < kRecords; i++) {
+            make_record(i, record.get());
+            CHECK(recorder.record(record->stamp, record->deadline, record->guess, record->params, record->output,
+                                  record->exitflag, record->info));
+        }
+    }
+    std::ifstream in(kPath, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/* offsets of the frames of LOG */
+std::vector<size_t> frames(const std::vector<char>& log)
+{
+    std::vector<size_t> offsets;
+    for (size_t at = kLogHeaderBytes; at + kFrameHeaderBytes <= log.size();) {
+        offsets.push_back(at);
+        std::uint32_t bytes;
+        std::memcpy(&bytes, &log[at + 4], sizeof(bytes));
+        at += kFrameHeaderBytes + bytes;
+    }
+    return offsets;
+}
+
+/* reads LOG back and checks that exactly the records EXPECTED come out, in order */
+void check_read(const std::vector<char>& log, const std::vector<int>& expected, bool skips)
+{
+    {
+        std::ofstream out(kPath, std::ios::binary | std::ios::trunc);
+        out.write(log.data(), static_cast<std::streamsize>(log.size()));
+    }
+    SolveLogReader reader;
+    CHECK(reader.open(kPath));
+    std::unique_ptr<SolveRecord> record(new SolveRecord), reference(new SolveRecord);
+    size_t n = 0;
+    while (reader.next(record.get())) {
+        CHECK(n < expected.size());
+        if (n >= expected.size()) break;
+        make_record(expected[n], reference.get());
+        CHECK(std::memcmp(record.get(), reference.get(), sizeof(SolveRecord)) == 0);
+        n++;
+    }
+    CHECK(n == expected.size());
+    CHECK((reader.skipped() > 0) == skips);
+}
+
+std::vector<int> all_but(int first, int last)
+{
+    std::vector<int> records;
+    for (int i = 0; i < kRecords; i++) {
+        if (i < first || i > last) records.push_back(i);
+    }
+    return records;
+}
+
+void check_recovery()
+{
+    const std::vector<char> log = write_log();
+    const std::vector<size_t> offsets = frames(log);
+    CHECK(offsets.size() == static_cast<size_t>(kRecords));
+    if (offsets.size() != static_cast<size_t>(kRecords)) return;
+
+    check_read(log, all_but(kRecords, kRecords), false);
+
+    /* a delta whose size is still plausible: without sync words every later frame would be misread */
+    std::vector<char> corrupt = log;
+    std::uint32_t bytes;
+    std::memcpy(&bytes, &corrupt[offsets[7] + 4], sizeof(bytes));
+    bytes /= 2;
+    std::memcpy(&corrupt[offsets[7] + 4], &bytes, sizeof(bytes));
+    check_read(corrupt, all_but(7, 9), true);
+
+    /* a flipped byte in the payload of a keyframe, which would still decode */
+    corrupt = log;
+    corrupt[(offsets[10] + kFrameHeaderBytes + offsets[11]) / 2] ^= 0x10;
+    check_read(corrupt, all_but(10, 14), true);
+
+    /* a size beyond any record, then a cut off end: keyframe 25 restores the records up to the cut */
+    corrupt = log;
+    std::memset(&corrupt[offsets[21] + 4], 0xff, 4);
+    corrupt.resize(offsets[28] + kFrameHeaderBytes + 5);
+    std::vector<int> expected = all_but(21, 24);
+    expected.resize(expected.size() - 2);
+    check_read(corrupt, expected, true);
+
+    std::remove(kPath);
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_recovery();
+    return check_result();
+}
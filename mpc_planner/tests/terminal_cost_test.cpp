@@ -0,0 +1,270 @@
+/*
+ * Terminal ingredients: P solves the Riccati equation and stabilizes the
+ * car, V and the terminal set against central differences, alpha against
+ * the bounds, and set_terminal_params on the kTerminalStages stages of
+ * FORCESNLPsolver_terminal.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "check.h"
+#include "mpc_planner/rk4_substeps.h"
+#include "mpc_planner/terminal_cost.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+constexpr int kN = kCarStates;
+constexpr int kM = kCarInputs;
+constexpr double kUntouched = -7;
+constexpr int kGuard = 4 * kTerminalStageParams;
+
+const double kXRef[kN] = { 0, 1.5, 0.5, 0 };
+const double kURef[kM] = { 0, 0 };
+const double kParams[kStageParams] = { kMass, kInertia };
+
+TerminalCost make_terminal(const TerminalConfig& config = TerminalConfig())
+{
+    TerminalCost terminal;
+    CHECK(terminal_ingredients(config, kXRef, kURef, kParams, &terminal));
+    return terminal;
+}
+
+/* C = A B, for N x N matrices */
+void multiply(const double A[kN][kN], const double B[kN][kN], double C[kN][kN])
+{
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kN; j++) {
+            C[i][j] = 0;
+            for (int k = 0; k < kN; k++) C[i][j] += A[i][k] * B[k][j];
+        }
+    }
+}
+
+void check_riccati()
+{
+    const TerminalConfig config;
+    const TerminalCost terminal = make_terminal(config);
+    double x_next[kN], A[kN][kN], B[kN][kM];
+    car_rk4_substeps(kXRef, kURef, kParams[0], kParams[1], config.step, config.substeps, x_next, A, B);
+
+    /* P = Q + A' P A - A' P B K with K = (R + B' P B)^-1 B' P A */
+    double PA[kN][kN], PB[kN][kM] = {};
+    multiply(terminal.P, A, PA);
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kM; j++) {
+            for (int k = 0; k < kN; k++) PB[i][j] += terminal.P[i][k] * B[k][j];
+        }
+    }
+    double size = 0;
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kN; j++) size = std::max(size, std::fabs(terminal.P[i][j]));
+    }
+    for (int i = 0; i < kM; i++) {
+        for (int j = 0; j < kN; j++) {
+            /* (R + B' P B) K = B' P A */
+            double lhs = config.input_weight[i] * terminal.K[i][j], rhs = 0;
+            for (int k = 0; k < kM; k++) {
+                double BPB = 0;
+                for (int l = 0; l < kN; l++) BPB += B[l][i] * PB[l][k];
+                lhs += BPB * terminal.K[k][j];
+            }
+            for (int l = 0; l < kN; l++) rhs += B[l][i] * PA[l][j];
+            CHECK_NEAR(lhs, rhs, 1e-8 * size);
+        }
+    }
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kN; j++) {
+            double value = i == j ? config.state_weight[i] : 0;
+            for (int k = 0; k < kN; k++) value += A[k][i] * PA[k][j];
+            for (int k = 0; k < kM; k++) {
+                double BPA = 0;
+                for (int l = 0; l < kN; l++) BPA += B[l][k] * PA[l][i];
+                value -= BPA * terminal.K[k][j];
+            }
+            CHECK_NEAR(terminal.P[i][j], value, 1e-8 * size);
+            CHECK(terminal.P[i][j] == terminal.P[j][i]);
+        }
+    }
+
+    /* the LQR law u = u_ref - K e stabilizes: the spectral radius of A - B K, as |M^1024|^(1/1024), is below 1 */
+    double M[kN][kN], square[kN][kN];
+    for (int i = 0; i < kN; i++) {
+        for (int j = 0; j < kN; j++) {
+            M[i][j] = A[i][j];
+            for (int k = 0; k < kM; k++) M[i][j] -= B[i][k] * terminal.K[k][j];
+        }
+    }
+    double log_norm = 0;
+    for (int n = 0; n < 10; n++) {
+        multiply(M, M, square);
+        /* rescaled to stay finite; the logarithm of the scale adds up */
+        double norm = 0;
+        for (int i = 0; i < kN; i++) {
+            for (int j = 0; j < kN; j++) norm = std::max(norm, std::fabs(square[i][j]));
+        }
+        log_norm = 2 * log_norm + std::log(norm);
+        for (int i = 0; i < kN; i++) {
+            for (int j = 0; j < kN; j++) M[i][j] = square[i][j] / norm;
+        }
+    }
+    CHECK(std::exp(log_norm / 1024) < 0.999);
+}
+
+void check_cost_and_set()
+{
+    const TerminalCost terminal = make_terminal();
+    std::mt19937 random(4);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    const double eps = 1e-6;
+    for (int n = 0; n < 20; n++) {
+        double z[kEgoStageVars];
+        for (int i = 0; i < kEgoStageVars; i++) z[i] = uniform(random);
+
+        double f = 0, nabla_f[kEgoStageVars] = {}, H[kEgoStageVars * kEgoStageVars] = {};
+        terminal_cost(terminal, z, &f, nabla_f, H);
+        constexpr int kRows = 3, kRow = 1;
+        double h[kRows] = {}, nabla_h[kRows * kEgoStageVars] = {};
+        terminal_set(terminal, z, kRow, kRows, h, nabla_h);
+
+        /* V = e' P e / 2, h = e' P e - alpha, their gradients P e and 2 P e and the Hessian P */
+        double e[kN], ePe = 0;
+        for (int i = 0; i < kN; i++) e[i] = z[kCarInputs + i] - terminal.x_ref[i];
+        for (int i = 0; i < kN; i++) {
+            double Pe = 0;
+            for (int j = 0; j < kN; j++) Pe += terminal.P[i][j] * e[j];
+            ePe += e[i] * Pe;
+            CHECK_NEAR(nabla_f[kCarInputs + i], Pe, 1e-12 * (1 + std::fabs(Pe)));
+            CHECK_NEAR(nabla_h[(kCarInputs + i) * kRows + kRow], 2 * Pe, 1e-12 * (1 + std::fabs(Pe)));
+        }
+        CHECK_NEAR(f, ePe / 2, 1e-12 * (1 + ePe));
+        CHECK_NEAR(h[kRow], ePe - terminal.alpha, 1e-12 * (1 + ePe));
+        CHECK(h[0] == 0 && h[2] == 0);
+        for (int a = 0; a < kEgoStageVars; a++) {
+            for (int b = 0; b < kEgoStageVars; b++) {
+                const double expected = a < kCarInputs || b < kCarInputs ? 0 : terminal.P[a - kCarInputs][b - kCarInputs];
+                CHECK(H[b * kEgoStageVars + a] == expected);
+            }
+            CHECK(nabla_h[a * kRows] == 0 && nabla_h[a * kRows + 2] == 0);
+        }
+
+        for (int j = 0; j < kEgoStageVars; j++) {
+            double plus[kEgoStageVars], minus[kEgoStageVars];
+            std::copy(z, z + kEgoStageVars, plus);
+            std::copy(z, z + kEgoStageVars, minus);
+            plus[j] += eps;
+            minus[j] -= eps;
+            double f_plus = 0, f_minus = 0, g_plus[kEgoStageVars] = {}, g_minus[kEgoStageVars] = {};
+            double h_plus[kRows], h_minus[kRows];
+            terminal_cost(terminal, plus, &f_plus, g_plus, nullptr);
+            terminal_cost(terminal, minus, &f_minus, g_minus, nullptr);
+            terminal_set(terminal, plus, kRow, kRows, h_plus, nullptr);
+            terminal_set(terminal, minus, kRow, kRows, h_minus, nullptr);
+            const double scale = 1 + std::fabs(nabla_f[j]);
+            CHECK_NEAR(nabla_f[j], (f_plus - f_minus) / (2 * eps), 1e-6 * scale);
+            CHECK_NEAR(nabla_h[j * kRows + kRow], (h_plus[kRow] - h_minus[kRow]) / (2 * eps), 2e-6 * scale);
+            for (int i = 0; i < kEgoStageVars; i++) {
+                CHECK_NEAR(H[j * kEgoStageVars + i], (g_plus[i] - g_minus[i]) / (2 * eps), 1e-6 * (1 + std::fabs(H[j * kEgoStageVars + i])));
+            }
+        }
+    }
+}
+
+/*
+ * On the boundary e' P e = alpha the LQR law and the states keep their
+ * bounds; without the set scale some boundary point comes close to one.
+ */
+void check_alpha()
+{
+    TerminalConfig config;
+    config.set_scale = 1;
+    const TerminalCost terminal = make_terminal(config);
+    CHECK(terminal.alpha > 0 && std::isfinite(terminal.alpha));
+
+    std::mt19937 random(6);
+    std::normal_distribution<double> normal;
+    double closest = kInf;
+    for (int n = 0; n < 100000; n++) {
+        double e[kN], ePe = 0;
+        for (int i = 0; i < kN; i++) e[i] = normal(random);
+        for (int i = 0; i < kN; i++) {
+            for (int j = 0; j < kN; j++) ePe += e[i] * terminal.P[i][j] * e[j];
+        }
+        for (int i = 0; i < kN; i++) e[i] *= std::sqrt(terminal.alpha / ePe);
+
+        double z[kEgoStageVars];
+        for (int i = 0; i < kM; i++) {
+            z[i] = terminal.u_ref[i];
+            for (int j = 0; j < kN; j++) z[i] -= terminal.K[i][j] * e[j];
+        }
+        for (int i = 0; i < kN; i++) z[kCarInputs + i] = terminal.x_ref[i] + e[i];
+        for (int i = 0; i < kEgoStageVars; i++) {
+            const double margin = std::min(kEgoUpperBounds[i] - z[i], z[i] - kEgoLowerBounds[i]);
+            CHECK(margin >= -1e-9);
+            closest = std::min(closest, margin / (kEgoUpperBounds[i] - kEgoLowerBounds[i]));
+        }
+    }
+    CHECK(closest < 0.01);
+}
+
+void check_set_terminal_params()
+{
+    const double* x_ref = kXRef;
+    const double* u_ref = kURef;
+    const TerminalCost terminal = make_terminal();
+
+    /* a 30 stage buffer followed by guard entries */
+    std::vector<double> buffer(kTerminalStages * kTerminalStageParams + kGuard, kUntouched);
+    set_terminal_params(buffer.data(), kTerminalStages, terminal);
+
+    for (int i = kTerminalStages * kTerminalStageParams; i < static_cast<int>(buffer.size()); i++) {
+        CHECK(buffer[i] == kUntouched);
+    }
+
+    /* inactive terminal rows before the last stage, the other parameters left alone */
+    for (int k = 0; k < kTerminalStages - 1; k++) {
+        const double* stage = buffer.data() + kTerminalStageParams * k;
+        for (int i = 0; i < kParamTerminal; i++) CHECK(stage[i] == kUntouched);
+        for (int i = 0; i < kTerminalAlpha; i++) CHECK(stage[kParamTerminal + kTerminalFactor + i] == 0);
+        CHECK(stage[kParamTerminal + kTerminalAlpha] == 1);
+    }
+
+    /* stage 30: the reference, no weight on the states, L L' = P and alpha */
+    const double* stage = buffer.data() + kTerminalStageParams * (kTerminalStages - 1);
+    const double* track = stage + kParamTracking;
+    for (int i = 0; i < kCarInputs; i++) CHECK(track[kTrackReference + i] == u_ref[i]);
+    for (int i = 0; i < kCarStates; i++) {
+        CHECK(track[kTrackReference + kCarInputs + i] == x_ref[i]);
+        CHECK(track[kTrackWeight + kCarInputs + i] == 0);
+    }
+    CHECK(stage[kParamTerminal + kTerminalAlpha] == terminal.alpha);
+    CHECK(terminal.alpha > 0 && terminal.alpha != 1);
+
+    double L[kCarStates][kCarStates] = {};
+    int index = kParamTerminal + kTerminalFactor;
+    for (int j = 0; j < kCarStates; j++) {
+        for (int i = j; i < kCarStates; i++) L[i][j] = stage[index++];
+    }
+    for (int i = 0; i < kCarStates; i++) {
+        for (int j = 0; j < kCarStates; j++) {
+            double LLt = 0;
+            for (int k = 0; k < kCarStates; k++) LLt += L[i][k] * L[j][k];
+            CHECK_NEAR(LLt, terminal.P[i][j], 1e-9 * std::fabs(terminal.P[i][i]));
+        }
+    }
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_riccati();
+    check_cost_and_set();
+    check_alpha();
+    check_set_terminal_params();
+    return check_result();
+}
@@ -0,0 +1,98 @@
+/*
+ * make_time_grid: the active steps span the horizon, growing from first_step,
+ * inactive stages get dt = 0, and configurations without a grid are
+ * rejected instead of hanging or producing NaN steps.
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "check.h"
+#include "mpc_planner/time_grid.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+/* the steps of STAGES active stages of CONFIG, and their times */
+void check_grid(const TimeGridConfig& config, int stages)
+{
+    double step[kStages], time[kStages];
+    CHECK(make_time_grid(config, step) == stages);
+    grid_times(step, time);
+
+    double sum = 0;
+    for (int k = 0; k < kStages; k++) {
+        if (k < stages - 1) {
+            CHECK(step[k] > 0);
+            if (k > 0) CHECK(step[k] >= step[k - 1] * (1 - 1e-12));
+        } else {
+            CHECK(step[k] == 0);
+        }
+        sum += step[k];
+        if (k + 1 < kStages) CHECK_NEAR(time[k + 1], time[k] + step[k], 1e-12);
+    }
+    CHECK(time[0] == 0);
+    if (stages > 1) {
+        CHECK_NEAR(sum, config.horizon, 1e-9 * config.horizon);
+        CHECK_NEAR(time[kStages - 1], config.horizon, 1e-9 * config.horizon);
+        if (config.first_step * (stages - 1) < config.horizon) CHECK_NEAR(step[0], config.first_step, 1e-15);
+    }
+}
+
+void check_grids()
+{
+    /* the uniform grid of the solver */
+    TimeGridConfig uniform;
+    uniform.first_step = kStepSize;
+    check_grid(uniform, kStages);
+
+    /* geometric growth over fewer stages */
+    TimeGridConfig geometric;
+    geometric.stages = 40;
+    geometric.first_step = 0.02;
+    geometric.horizon = 6;
+    check_grid(geometric, 40);
+
+    /* first_step too coarse: uniform over the horizon */
+    TimeGridConfig coarse;
+    coarse.stages = 10;
+    coarse.first_step = 1;
+    coarse.horizon = 3;
+    check_grid(coarse, 10);
+
+    /* stages clamped to the solver */
+    TimeGridConfig many;
+    many.stages = 2 * kStages;
+    check_grid(many, kStages);
+}
+
+void check_rejected()
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double bad_steps[] = { -0.05, 0, nan, kInf };
+    const double bad_horizons[] = { -1, 0, nan, kInf };
+    for (double first_step : bad_steps) {
+        TimeGridConfig config;
+        config.first_step = first_step;
+        double step[kStages];
+        CHECK(make_time_grid(config, step) == 0);
+        for (int k = 0; k < kStages; k++) CHECK(step[k] == 0);
+    }
+    for (double horizon : bad_horizons) {
+        TimeGridConfig config;
+        config.horizon = horizon;
+        double step[kStages];
+        CHECK(make_time_grid(config, step) == 0);
+        for (int k = 0; k < kStages; k++) CHECK(step[k] == 0);
+    }
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_grids();
+    check_rejected();
+    return check_result();
+}
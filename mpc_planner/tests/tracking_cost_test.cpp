@@ -0,0 +1,138 @@
+/*
+ * Tracking cost: the gradient against central differences, the Gauss-Newton
+ * Hessian against J' J of the residuals, and the parameter layout of
+ * set_tracking_reference.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "check.h"
+#include "mpc_planner/tracking_cost.h"
+
+using namespace mpc_planner;
+
+namespace {
+
+constexpr int kTestStages = 5;
+constexpr int kResiduals = kEgoStageVars + 1;
+constexpr double kUntouched = -7;
+
+/* r = [sqrt(q) (z - z_ref); sqrt(w_lane) (x^2 + y^2 - r_lane^2)] */
+void residuals(const double z[kEgoStageVars], const TrackingReference& reference, double r[kResiduals])
+{
+    for (int i = 0; i < kEgoStageVars; i++) r[i] = std::sqrt(reference.weight[i]) * (z[i] - reference.z[i]);
+    const double x = z[kCarInputs + kX], y = z[kCarInputs + kY];
+    r[kEgoStageVars] = std::sqrt(reference.lane_weight) * (x * x + y * y - reference.lane_radius * reference.lane_radius);
+}
+
+void check_layout()
+{
+    TrackingReference reference;
+    for (int i = 0; i < kEgoStageVars; i++) {
+        reference.z[i] = 1 + i;
+        reference.weight[i] = 10 + i;
+    }
+    reference.lane_radius = 20;
+    reference.lane_weight = 21;
+
+    double stage[kTrackingStageParams + 1];
+    std::fill(stage, stage + kTrackingStageParams + 1, kUntouched);
+    set_tracking_reference(stage, reference);
+    for (int i = 0; i < kParamTracking; i++) CHECK(stage[i] == kUntouched);
+    for (int i = 0; i < kEgoStageVars; i++) {
+        CHECK(stage[kParamTracking + kTrackReference + i] == 1 + i);
+        CHECK(stage[kParamTracking + kTrackWeight + i] == 10 + i);
+    }
+    CHECK(stage[kParamTracking + kTrackLaneRadius] == 20);
+    CHECK(stage[kParamTracking + kTrackLaneWeight] == 21);
+    CHECK(kParamTracking + kTrackingParams == kTrackingStageParams);
+    CHECK(stage[kTrackingStageParams] == kUntouched);
+}
+
+void check_derivatives()
+{
+    std::mt19937 random(3);
+    std::uniform_real_distribution<double> uniform(-1, 1), positive(0.1, 2);
+
+    /* every stage its own reference and weights */
+    std::vector<double> all_parameters(kTestStages * kTrackingStageParams, 0.0);
+    TrackingReference references[kTestStages];
+    for (int k = 0; k < kTestStages; k++) {
+        TrackingReference& reference = references[k];
+        for (int i = 0; i < kEgoStageVars; i++) {
+            reference.z[i] = uniform(random);
+            reference.weight[i] = positive(random);
+        }
+        reference.lane_radius = 1 + positive(random);
+        reference.lane_weight = positive(random);
+        set_tracking_reference(all_parameters.data() + kTrackingStageParams * k, reference);
+    }
+
+    const double eps = 1e-6;
+    for (int n = 0; n < 20; n++) {
+        for (int k = 0; k < kTestStages; k++) {
+            const double* p = all_parameters.data() + kTrackingStageParams * k;
+            double z[kEgoStageVars];
+            for (int i = 0; i < kEgoStageVars; i++) z[i] = 2 * uniform(random);
+
+            double f = 0, nabla_f[kEgoStageVars], H[kEgoStageVars * kEgoStageVars];
+            tracking_cost(z, p, &f, nabla_f, H);
+
+            /* f = r' r / 2 */
+            double r[kResiduals];
+            residuals(z, references[k], r);
+            double rr = 0;
+            for (int i = 0; i < kResiduals; i++) rr += r[i] * r[i];
+            CHECK_NEAR(f, rr / 2, 1e-12 * std::max(1.0, rr));
+
+            /* J of the residuals and the gradient, by central differences */
+            double J[kResiduals][kEgoStageVars];
+            for (int j = 0; j < kEgoStageVars; j++) {
+                double plus[kEgoStageVars], minus[kEgoStageVars];
+                std::copy(z, z + kEgoStageVars, plus);
+                std::copy(z, z + kEgoStageVars, minus);
+                plus[j] += eps;
+                minus[j] -= eps;
+                double f_plus = 0, f_minus = 0, r_plus[kResiduals], r_minus[kResiduals];
+                tracking_cost(plus, p, &f_plus, nullptr, nullptr);
+                tracking_cost(minus, p, &f_minus, nullptr, nullptr);
+                residuals(plus, references[k], r_plus);
+                residuals(minus, references[k], r_minus);
+                CHECK_NEAR(nabla_f[j], (f_plus - f_minus) / (2 * eps), 1e-6 * std::max(1.0, std::fabs(nabla_f[j])));
+                for (int i = 0; i < kResiduals; i++) J[i][j] = (r_plus[i] - r_minus[i]) / (2 * eps);
+            }
+            for (int a = 0; a < kEgoStageVars; a++) {
+                for (int b = 0; b < kEgoStageVars; b++) {
+                    double JtJ = 0;
+                    for (int i = 0; i < kResiduals; i++) JtJ += J[i][a] * J[i][b];
+                    CHECK_NEAR(H[b * kEgoStageVars + a], JtJ, 1e-6 * std::max(1.0, std::fabs(JtJ)));
+                }
+            }
+        }
+    }
+}
+
+/* lane_reference charges the stage cost of two_obstacles_ego.m */
+void check_lane_reference()
+{
+    double p[kTrackingStageParams] = {};
+    set_tracking_reference(p, lane_reference());
+    const double z[kEgoStageVars] = { 0.3, -0.2, 1.1, 0.7, 0.4, 0.5 };
+    double f = 0;
+    tracking_cost(z, p, &f, nullptr, nullptr);
+    const double lane = 1.1 * 1.1 + 0.7 * 0.7 - 2.25;
+    CHECK_NEAR(f, 0.1 * (0.3 * 0.3 + 0.1 * 0.2 * 0.2 + 0.1 * lane * lane), 1e-15);
+}
+
+}  /* namespace */
+
+int main()
+{
+    check_layout();
+    check_derivatives();
+    check_lane_reference();
+    return check_result();
+}
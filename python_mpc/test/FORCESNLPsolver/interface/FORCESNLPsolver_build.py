@@ -32,6 +32,12 @@ import distutils
 # determine source file
 sourcefile = os.path.join(os.getcwd(),"FORCESNLPsolver","src","FORCESNLPsolver"+".c")
 
+# CasADi model and adapter, passed to the solver as external function evaluation
+extsources = [os.path.join(os.getcwd(),"FORCESNLPsolver_casadi2forces.c"),
+	os.path.join(os.getcwd(),"FORCESNLPsolver_model_1.c"),
+	os.path.join(os.getcwd(),"FORCESNLPsolver_model_85.c"),
+	os.path.join(os.getcwd(),"FORCESNLPsolver_deadline.c")]
+
 # determine lib file
 if sys.platform.startswith('win'):
 	libfile = os.path.join(os.getcwd(),"FORCESNLPsolver","lib","FORCESNLPsolver"+".lib")
@@ -46,16 +52,25 @@ if not os.path.exists(os.path.join(os.getcwd(),"FORCESNLPsolver","lib")):
 				
 # compile into object file
 objdir = os.path.join(os.getcwd(),"FORCESNLPsolver","obj")
+if os.path.exists(sourcefile):
+	sources = [sourcefile] + extsources
+	prebuilt = []
+else:
+	# only the object file of the solver has been shipped
+	sources = extsources
+	prebuilt = [os.path.join(objdir,"FORCESNLPsolver"+c.obj_extension)]
 if isinstance(c,distutils.unixccompiler.UnixCCompiler):
-	objects = c.compile([sourcefile], output_dir=objdir, extra_preargs=['-O3','-fPIC','-fopenmp','-mavx'])
+	objects = c.compile(sources, output_dir=objdir, extra_preargs=['-O3','-fPIC','-fopenmp','-mavx'])
 	if sys.platform.startswith('linux'):
 		c.set_libraries(['rt','gomp'])
 else:
-	objects = c.compile([sourcefile], output_dir=objdir)
+	objects = c.compile(sources, output_dir=objdir)
+objects = prebuilt + objects
 
 				
 # create libraries
 libdir = os.path.join(os.getcwd(),"FORCESNLPsolver","lib")
-exportsymbols = ["%s_solve" % "FORCESNLPsolver"]
+exportsymbols = ["%s_solve" % "FORCESNLPsolver", "%s_casadi2forces" % "FORCESNLPsolver", "%s_casadi2forces_deadline" % "FORCESNLPsolver",
+	"%s_set_deadline" % "FORCESNLPsolver", "%s_cancel" % "FORCESNLPsolver", "%s_expired" % "FORCESNLPsolver"]
 c.create_static_lib(objects, "FORCESNLPsolver", output_dir=libdir)
 c.link_shared_lib(objects, "FORCESNLPsolver", output_dir=libdir, export_symbols=exportsymbols)
\ No newline at end of file
@@ -362,8 +362,17 @@ class FORCESNLPsolver_info(ctypes.Structure):
 ('res_eq', ctypes.c_double),
 ('res_ineq', ctypes.c_double),
 ('pobj',ctypes.c_double),
+('dobj',ctypes.c_double),
+('dgap',ctypes.c_double),
+('rdgap',ctypes.c_double),
 ('mu',ctypes.c_double),
-('solvetime',ctypes.c_double)
+('mu_aff',ctypes.c_double),
+('sigma',ctypes.c_double),
+('lsit_aff',ctypes.c_int),
+('lsit_cc',ctypes.c_int),
+('step_aff',ctypes.c_double),
+('step_cc',ctypes.c_double),
+('solvetime',ctypes.c_double),
 ('fevalstime',ctypes.c_double)
 ]
 
@@ -375,8 +384,11 @@ if sys.version_info.major == 2:
 	PyFile_AsFile.restype = ctypes.POINTER(FILE)
 
 # determine data types for solver function prototype 
-csolver.argtypes = ( ctypes.POINTER(FORCESNLPsolver_params_ctypes), ctypes.POINTER(FORCESNLPsolver_outputs_ctypes), ctypes.POINTER(FORCESNLPsolver_info), ctypes.POINTER(FILE))
+csolver.argtypes = ( ctypes.POINTER(FORCESNLPsolver_params_ctypes), ctypes.POINTER(FORCESNLPsolver_outputs_ctypes), ctypes.POINTER(FORCESNLPsolver_info), ctypes.POINTER(FILE), ctypes.c_void_p)
 csolver.restype = ctypes.c_int
+
+# the CasADi adapter is linked into the solver library and passed as external function evaluation
+cextfunc = ctypes.cast(getattr(_lib,'FORCESNLPsolver_casadi2forces'), ctypes.c_void_p)
 
 def FORCESNLPsolver_solve(params_arg):
 	'''
@@ -522,7 +534,7 @@ a Python wrapper for a fast solver generated by FORCES Pro
 			fp = sys.stdout
 		try:
 			PyFile_AsFile.restype = ctypes.POINTER(FILE)
-			exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), PyFile_AsFile(fp) )
+			exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), PyFile_AsFile(fp), cextfunc )
 			#fp = open('stdout_temp.txt','r')
 			#print (fp.read())
 			#fp.close()
@@ -543,9 +555,9 @@ a Python wrapper for a fast solver generated by FORCES Pro
 
 		try:
 			if sys.platform.startswith('win'):
-				exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), None )
+				exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), None, cextfunc )
 			else:
-				exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), fp )
+				exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), fp, cextfunc )
 			libc.fclose(fp)
 			fptemp = open('stdout_temp.txt','r')
 			print (fptemp.read())
@@ -563,3 +575,358 @@ a Python wrapper for a fast solver generated by FORCES Pro
 solve = FORCESNLPsolver_solve
 
 
+# BATCH AND ASYNCHRONOUS SOLVES ----------------------------------------
+# The solver keeps its workspace in statically allocated memory, so two
+# solves can never share one loaded library. Every concurrent solve therefore
+# runs on its own private copy of the shared library (a solver context);
+# ctypes releases the GIL during the foreign call, so the copies run truly
+# in parallel and never stall the interpreter.
+import atexit
+import shutil
+import tempfile
+import threading
+
+_context_dir = None
+_context_count = [0]
+_context_free = []
+_context_lock = threading.Lock()
+
+class _SolverContext(object):
+	'''
+	A private copy of the solver library with its own workspace.
+	'''
+	def __init__(self, path):
+		self.lib = ctypes.CDLL(path)
+		self.solve = getattr(self.lib,'FORCESNLPsolver_solve')
+		self.solve.argtypes = csolver.argtypes
+		self.solve.restype = ctypes.c_int
+		self.extfunc = ctypes.cast(getattr(self.lib,'FORCESNLPsolver_casadi2forces_deadline'), ctypes.c_void_p)
+		self.set_deadline = getattr(self.lib,'FORCESNLPsolver_set_deadline')
+		self.set_deadline.argtypes = [ctypes.c_double]
+		self.set_deadline.restype = None
+		self.cancel = getattr(self.lib,'FORCESNLPsolver_cancel')
+		self.cancel.restype = None
+
+def _acquire_context():
+	global _context_dir
+	with _context_lock:
+		if _context_free:
+			return _context_free.pop()
+		if _context_dir is None:
+			_context_dir = tempfile.mkdtemp(prefix='FORCESNLPsolver_')
+			atexit.register(shutil.rmtree, _context_dir, True)
+		base, ext = os.path.splitext(os.path.basename(_lib._name))
+		path = os.path.join(_context_dir, '%s_context%d%s' % (base, _context_count[0], ext))
+		_context_count[0] += 1
+	shutil.copyfile(_lib._name, path)
+	return _SolverContext(path)
+
+def _release_context(ctx):
+	with _context_lock:
+		_context_free.append(ctx)
+
+_libc_handle = []
+
+def _libc():
+	if not _libc_handle:
+		if sys.platform.startswith('win'):
+			libc = ctypes.cdll.msvcrt
+		elif sys.platform.startswith('darwin'):
+			libc = ctypes.CDLL('libc.dylib')
+		else:
+			libc = ctypes.CDLL('libc.so.6')
+		libc.fopen.restype = ctypes.POINTER(FILE)
+		libc.fopen.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+		libc.fclose.argtypes = [ctypes.POINTER(FILE)]
+		_libc_handle.append(libc)
+	return _libc_handle[0]
+
+def _run_context(ctx, params_c, outputs_c, info_c, deadline, armed=False):
+	'''
+	Solves one instance on CTX with progress printing discarded. DEADLINE is
+	in seconds from now, None for no deadline. With ARMED the caller has
+	already armed the deadline of CTX and it is left as it is.
+	'''
+	libc = _libc()
+	fp = None if sys.platform.startswith('win') else libc.fopen(os.devnull.encode('utf-8'), 'w'.encode('utf-8'))
+	try:
+		if not armed:
+			ctx.set_deadline(deadline if deadline is not None else 0)
+		return ctx.solve(ctypes.byref(params_c), ctypes.byref(outputs_c), ctypes.byref(info_c), fp, ctx.extfunc)
+	finally:
+		if fp:
+			libc.fclose(fp)
+
+def _stack(name, arg, size):
+	arr = np.require(arg, dtype=np.float64)
+	if arr.ndim == 1:
+		arr = np.reshape(arr, (1, np.size(arr)))
+	if arr.ndim != 2 or arr.shape[1] != size:
+		raise ValueError('Parameter ' + name + ' must be an array of shape (B,%d).' % size)
+	return arr
+
+def FORCESNLPsolver_solve_batch(xinit, x0, all_parameters, workers=None):
+	'''
+   [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver_py.FORCESNLPsolver_solve_batch(XINIT, X0, ALL_PARAMETERS)
+   solves B independent problem instances, where
+       XINIT          - array of shape (B,12)
+       X0             - array of shape (B,1530)
+       ALL_PARAMETERS - array of shape (B,170)
+   hold one instance per row. A single row is broadcast to all instances.
+
+   The instances are distributed over WORKERS native threads (default: number
+   of CPUs), each with its own solver context.
+
+   OUTPUT is a dictionary with the same keys as for FORCESNLPsolver_solve, where
+       OUTPUT['x01'] ... OUTPUT['x85'] - arrays of shape (B,18)
+   and OUTPUT['z'] is the stacked trajectory of shape (B,85,18).
+   EXITFLAG is an integer array of shape (B,) and INFO a numpy record array of
+   shape (B,) with the fields of FORCESNLPsolver_info.
+	'''
+	xinit = _stack('xinit', xinit, 12)
+	x0 = _stack('x0', x0, 1530)
+	all_parameters = _stack('all_parameters', all_parameters, 170)
+	batch = max(xinit.shape[0], x0.shape[0], all_parameters.shape[0])
+	for name, arr in (('xinit', xinit), ('x0', x0), ('all_parameters', all_parameters)):
+		if arr.shape[0] not in (1, batch):
+			raise ValueError('Parameter ' + name + ' does not match the batch size %d.' % batch)
+
+	# pack all instances into contiguous ctypes arrays that the workers write into directly
+	params_c = (FORCESNLPsolver_params_ctypes * batch)()
+	outputs_c = (FORCESNLPsolver_outputs_ctypes * batch)()
+	info_c = (FORCESNLPsolver_info * batch)()
+	params_np = npct.as_array(params_c)
+	params_np['xinit'][:] = xinit
+	params_np['x0'][:] = x0
+	params_np['all_parameters'][:] = all_parameters
+	exitflags = np.zeros(batch, dtype=np.int32)
+
+	if workers is None:
+		try:
+			import multiprocessing
+			workers = multiprocessing.cpu_count()
+		except NotImplementedError:
+			workers = 1
+	workers = max(1, min(int(workers), batch))
+
+	next_instance = [0]
+	next_lock = threading.Lock()
+	errors = []
+
+	def work():
+		try:
+			ctx = _acquire_context()
+			try:
+				while True:
+					with next_lock:
+						i = next_instance[0]
+						next_instance[0] += 1
+					if i >= batch:
+						break
+					exitflags[i] = _run_context(ctx, params_c[i], outputs_c[i], info_c[i], None)
+			finally:
+				_release_context(ctx)
+		except Exception as e:
+			errors.append(e)
+
+	threads = [threading.Thread(target=work) for w in range(workers)]
+	for t in threads:
+		t.start()
+	for t in threads:
+		t.join()
+	if errors:
+		raise errors[0]
+
+	# convert outputs: per-stage views into one stacked trajectory array
+	z = np.frombuffer(outputs_c, dtype=np.float64).reshape(batch, 85, 18)
+	outputs = {'z' : z}
+	for k, out in enumerate(sorted(FORCESNLPsolver_outputs)):
+		outputs[out] = z[:, k, :]
+
+	return outputs, exitflags, npct.as_array(info_c).view(np.recarray)
+
+solve_batch = FORCESNLPsolver_solve_batch
+
+
+# SCENARIO CORPUS -------------------------------------------------------
+# Problem instances in the format of FORCESNLPsolver_corpus.h: a 64 byte
+# header followed by fixed-size records of native doubles.
+_corpus_header = np.dtype([('magic', 'S8'), ('version', np.uint32), ('byte_order', np.uint32),
+	('header_size', np.uint32), ('record_size', np.uint32), ('nxinit', np.uint32), ('nx0', np.uint32),
+	('npar', np.uint32), ('noutput', np.uint32), ('flags', np.uint32), ('reserved', np.uint8, 20)])
+
+def _corpus_record(reference):
+	fields = [('xinit', np.float64, 12), ('x0', np.float64, 1530), ('all_parameters', np.float64, 170)]
+	if reference:
+		fields += [('output', np.float64, 1530), ('exitflag', np.int32), ('iterations', np.int32)]
+	return np.dtype(fields)
+
+def FORCESNLPsolver_load_corpus(filename):
+	'''
+   CORPUS = FORCESNLPsolver_py.FORCESNLPsolver_load_corpus(FILENAME)
+   maps a scenario corpus without copying it. CORPUS is a dictionary of
+   read-only arrays with one instance per row:
+       CORPUS['xinit']          - shape (B,12)
+       CORPUS['x0']             - shape (B,1530)
+       CORPUS['all_parameters'] - shape (B,170)
+   and, if the corpus holds reference results, CORPUS['output'] of shape
+   (B,1530), CORPUS['exitflag'] and CORPUS['iterations'] of shape (B,). The
+   first three can be passed to FORCESNLPsolver_solve_batch directly.
+	'''
+	header = np.fromfile(filename, dtype=_corpus_header, count=1)
+	if header.size != 1 or header['magic'][0] != b'FNLPCORP':
+		raise ValueError(filename + ' is not a corpus.')
+	header = header[0]
+	if header['version'] > 1 or header['byte_order'] != 0x01020304:
+		raise ValueError(filename + ' has a newer version or another byte order.')
+	record = _corpus_record(header['flags'] & 1)
+	if header['nxinit'] != 12 or header['nx0'] != 1530 or header['npar'] != 170 or header['record_size'] < record.itemsize:
+		raise ValueError(filename + ' does not match FORCESNLPsolver.')
+	# records of later versions may be longer, the known fields come first
+	record = np.dtype({'names': record.names, 'formats': [record.fields[n][0] for n in record.names],
+		'offsets': [record.fields[n][1] for n in record.names], 'itemsize': int(header['record_size'])})
+	size = os.path.getsize(filename) - int(header['header_size'])
+	count = size // record.itemsize
+	if count == 0:
+		return dict((name, np.zeros((0,) + record.fields[name][0].shape, record.fields[name][0].base)) for name in record.names)
+	records = np.memmap(filename, dtype=record, mode='r', offset=int(header['header_size']), shape=(count,))
+	return dict((name, records[name]) for name in record.names)
+
+load_corpus = FORCESNLPsolver_load_corpus
+
+def FORCESNLPsolver_write_corpus(filename, xinit, x0, all_parameters, output=None, exitflag=None, iterations=None):
+	'''
+   FORCESNLPsolver_py.FORCESNLPsolver_write_corpus(FILENAME, XINIT, X0, ALL_PARAMETERS)
+   appends B instances, arrays of the shapes of FORCESNLPsolver_solve_batch,
+   to a scenario corpus, writing the header if the file is new.
+
+   FORCESNLPsolver_write_corpus(..., OUTPUT, EXITFLAG, ITERATIONS) also stores
+   reference results: OUTPUT['z'] of FORCESNLPsolver_solve_batch or an array
+   of shape (B,1530), and arrays of shape (B,). All records of a file either
+   have references or not.
+	'''
+	xinit = _stack('xinit', xinit, 12)
+	x0 = _stack('x0', x0, 1530)
+	all_parameters = _stack('all_parameters', all_parameters, 170)
+	batch = max(xinit.shape[0], x0.shape[0], all_parameters.shape[0])
+	reference = output is not None
+	record = _corpus_record(reference)
+	records = np.zeros(batch, dtype=record)
+	records['xinit'] = xinit
+	records['x0'] = x0
+	records['all_parameters'] = all_parameters
+	if reference:
+		if isinstance(output, dict):
+			output = output['z']
+		records['output'] = np.reshape(output, (batch, 1530))
+		records['exitflag'] = exitflag
+		records['iterations'] = iterations
+
+	header = np.zeros(1, dtype=_corpus_header)
+	header['magic'] = b'FNLPCORP'
+	header['version'] = 1
+	header['byte_order'] = 0x01020304
+	header['header_size'] = _corpus_header.itemsize
+	header['record_size'] = record.itemsize
+	header['nxinit'], header['nx0'], header['npar'] = 12, 1530, 170
+	header['noutput'] = 1530 if reference else 0
+	header['flags'] = 1 if reference else 0
+
+	with open(filename, 'ab+') as f:
+		f.seek(0, os.SEEK_END)
+		if f.tell() == 0:
+			f.write(header.tobytes())
+		else:
+			f.seek(0)
+			existing = np.frombuffer(f.read(_corpus_header.itemsize), dtype=_corpus_header)
+			if existing.size != 1 or existing.tobytes()[:44] != header.tobytes()[:44]:
+				raise ValueError(filename + ' has another version or record layout.')
+			f.seek(0, os.SEEK_END)
+		f.write(records.tobytes())
+
+write_corpus = FORCESNLPsolver_write_corpus
+
+if sys.version_info.major == 3:
+	import asyncio
+	import concurrent.futures
+
+	class FORCESNLPsolver_future(concurrent.futures.Future):
+		'''
+		Future of an asynchronous solve. Its result is the tuple
+		(OUTPUT, EXITFLAG, INFO) of FORCESNLPsolver_solve; it can be awaited
+		from an asyncio event loop.
+
+		cancel() behaves as for any concurrent.futures.Future: it only
+		succeeds before the solve has started. stop() ends a running solve
+		early by arming the deadline of its solver context: the solver stops
+		within one iteration and the future completes normally with EXITFLAG
+		-6 (FORCESNLPsolver_BADFUNCEVAL) and the last iterate.
+		'''
+		def __init__(self):
+			concurrent.futures.Future.__init__(self)
+			self._ctx = None
+			self._ctx_lock = threading.Lock()
+
+		def stop(self):
+			'''
+			Stops a running solve early; returns False if it is not running.
+			'''
+			with self._ctx_lock:
+				if self._ctx is None:
+					return False
+				self._ctx.cancel()
+				return True
+
+		def __await__(self):
+			return asyncio.wrap_future(self).__await__()
+
+	def FORCESNLPsolver_solve_async(params_arg, deadline=None):
+		'''
+   FUTURE = FORCESNLPsolver_py.FORCESNLPsolver_solve_async(PARAMS) starts the
+   solve of FORCESNLPsolver_solve on a native background thread and returns
+   immediately. FUTURE.result() or "await FUTURE" deliver (OUTPUT, EXITFLAG, INFO).
+
+   DEADLINE is the time budget in seconds; when it expires the solver stops
+   with EXITFLAG -6 and returns its last iterate. FUTURE.stop() stops a
+   running solve the same way; FUTURE.cancel() only withdraws a solve that
+   has not started yet.
+		'''
+		params_c = FORCESNLPsolver_params_ctypes()
+		for par in params_arg:
+			try:
+				arr = np.require(params_arg[par], dtype=np.float64, requirements='F')
+				setattr(params_c, par, npct.as_ctypes(np.reshape(arr,np.size(arr),order='F')))
+			except:
+				raise ValueError('Parameter ' + par + ' does not have the appropriate dimensions or data type. Please use numpy arrays for parameters.')
+		outputs_c = FORCESNLPsolver_outputs_ctypes()
+		info_c = FORCESNLPsolver_info()
+		future = FORCESNLPsolver_future()
+
+		def work():
+			if not future.set_running_or_notify_cancel():
+				return
+			try:
+				ctx = _acquire_context()
+				# arming clears a cancel, so arm before stop() can see the context
+				ctx.set_deadline(deadline if deadline is not None else 0)
+				with future._ctx_lock:
+					future._ctx = ctx
+				try:
+					exitflag = _run_context(ctx, params_c, outputs_c, info_c, deadline, armed=True)
+				finally:
+					with future._ctx_lock:
+						future._ctx = None
+					_release_context(ctx)
+				outputs = {}
+				for out in FORCESNLPsolver_outputs:
+					outputs[out] = npct.as_array(getattr(outputs_c,out))
+				future.set_result((outputs, int(exitflag), info_c))
+			except Exception as e:
+				future.set_exception(e)
+
+		thread = threading.Thread(target=work)
+		thread.daemon = True
+		thread.start()
+		return future
+
+	solve_async = FORCESNLPsolver_solve_async
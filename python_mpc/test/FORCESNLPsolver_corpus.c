@@ -0,0 +1,223 @@
+/*  * Scenario corpus of FORCESNLPsolver problem instances, see FORCESNLPsolver_corpus.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "FORCESNLPsolver_corpus.h"
+
+#define CORPUS_NXINIT (sizeof(((FORCESNLPsolver_params *)0)->xinit) / sizeof(double))
+#define CORPUS_NX0 (sizeof(((FORCESNLPsolver_params *)0)->x0) / sizeof(double))
+#define CORPUS_NPAR (sizeof(((FORCESNLPsolver_params *)0)->all_parameters) / sizeof(double))
+#define CORPUS_NOUTPUT (sizeof(FORCESNLPsolver_output) / sizeof(double))
+
+void FORCESNLPsolver_corpus_init_header(FORCESNLPsolver_corpus_header *header, int reference)
+{
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, FORCESNLPsolver_CORPUS_MAGIC, sizeof(header->magic));
+    header->version = FORCESNLPsolver_CORPUS_VERSION;
+    header->byte_order = FORCESNLPsolver_CORPUS_BYTE_ORDER;
+    header->header_size = sizeof(FORCESNLPsolver_corpus_header);
+    header->nxinit = CORPUS_NXINIT;
+    header->nx0 = CORPUS_NX0;
+    header->npar = CORPUS_NPAR;
+    header->noutput = reference ? CORPUS_NOUTPUT : 0;
+    header->flags = reference ? FORCESNLPsolver_CORPUS_REFERENCE : 0;
+    header->record_size = sizeof(FORCESNLPsolver_params)
+                        + (reference ? sizeof(FORCESNLPsolver_output) + sizeof(FORCESNLPsolver_corpus_result) : 0);
+}
+
+int FORCESNLPsolver_corpus_check_header(const FORCESNLPsolver_corpus_header *header)
+{
+    FORCESNLPsolver_corpus_header expected;
+
+    if( memcmp(header->magic, FORCESNLPsolver_CORPUS_MAGIC, sizeof(header->magic)) != 0 ){
+        return FORCESNLPsolver_CORPUS_EFORMAT;
+    }
+    if( header->version > FORCESNLPsolver_CORPUS_VERSION || header->byte_order != FORCESNLPsolver_CORPUS_BYTE_ORDER ){
+        return FORCESNLPsolver_CORPUS_EVERSION;
+    }
+    /* header_size and record_size let later versions grow both; records stay 8 byte aligned */
+    if( header->header_size < sizeof(FORCESNLPsolver_corpus_header) || header->header_size % 8 != 0 || header->record_size % 8 != 0 ){
+        return FORCESNLPsolver_CORPUS_EFORMAT;
+    }
+
+    FORCESNLPsolver_corpus_init_header(&expected, (header->flags & FORCESNLPsolver_CORPUS_REFERENCE) != 0);
+    if( header->nxinit != expected.nxinit || header->nx0 != expected.nx0 || header->npar != expected.npar
+        || header->noutput != expected.noutput || header->record_size < expected.record_size ){
+        return FORCESNLPsolver_CORPUS_EMISMATCH;
+    }
+    return FORCESNLPsolver_CORPUS_OK;
+}
+
+int FORCESNLPsolver_corpus_open(FORCESNLPsolver_corpus *corpus, const char *path)
+{
+    const FORCESNLPsolver_corpus_header *header;
+    int status;
+
+    memset(corpus, 0, sizeof(*corpus));
+#ifndef _WIN32
+    {
+        struct stat st;
+        void *map;
+        int fd = open(path, O_RDONLY);
+        if( fd < 0 ){
+            return FORCESNLPsolver_CORPUS_EIO;
+        }
+        if( fstat(fd, &st) != 0 ){
+            close(fd);
+            return FORCESNLPsolver_CORPUS_EIO;
+        }
+        if( (size_t)st.st_size < sizeof(FORCESNLPsolver_corpus_header) ){
+            close(fd);
+            return FORCESNLPsolver_CORPUS_EFORMAT;
+        }
+        /* copy-on-write: FORCESNLPsolver_solve takes non-const params, a write never reaches the file */
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if( map == MAP_FAILED ){
+            return FORCESNLPsolver_CORPUS_EIO;
+        }
+        /* records are read once, front to back */
+        madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+        corpus->data = (const unsigned char *)map;
+        corpus->size = (size_t)st.st_size;
+        corpus->mapped = 1;
+    }
+#else
+    {
+        unsigned char *data;
+        long size;
+        FILE *in = fopen(path, "rb");
+        if( !in ){
+            return FORCESNLPsolver_CORPUS_EIO;
+        }
+        fseek(in, 0, SEEK_END);
+        size = ftell(in);
+        fseek(in, 0, SEEK_SET);
+        if( size < (long)sizeof(FORCESNLPsolver_corpus_header) ){
+            fclose(in);
+            return FORCESNLPsolver_CORPUS_EFORMAT;
+        }
+        data = (unsigned char *)malloc((size_t)size);
+        if( !data || fread(data, 1, (size_t)size, in) != (size_t)size ){
+            free(data);
+            fclose(in);
+            return FORCESNLPsolver_CORPUS_EIO;
+        }
+        fclose(in);
+        corpus->data = data;
+        corpus->size = (size_t)size;
+    }
+#endif
+
+    header = (const FORCESNLPsolver_corpus_header *)corpus->data;
+    status = FORCESNLPsolver_corpus_check_header(header);
+    if( status != FORCESNLPsolver_CORPUS_OK ){
+        FORCESNLPsolver_corpus_close(corpus);
+        return status;
+    }
+    /* a truncated file, or a header_size beyond it, would wrap the count below */
+    if( corpus->size < header->header_size ){
+        FORCESNLPsolver_corpus_close(corpus);
+        return FORCESNLPsolver_CORPUS_EFORMAT;
+    }
+    corpus->header = header;
+    /* a partly written last record is ignored */
+    corpus->count = (corpus->size - header->header_size) / header->record_size;
+    return FORCESNLPsolver_CORPUS_OK;
+}
+
+void FORCESNLPsolver_corpus_close(FORCESNLPsolver_corpus *corpus)
+{
+    if( corpus->data ){
+#ifndef _WIN32
+        if( corpus->mapped ){
+            munmap((void *)corpus->data, corpus->size);
+        }
+#else
+        free((void *)corpus->data);
+#endif
+    }
+    memset(corpus, 0, sizeof(*corpus));
+}
+
+const FORCESNLPsolver_params *FORCESNLPsolver_corpus_params(const FORCESNLPsolver_corpus *corpus, size_t i)
+{
+    return (const FORCESNLPsolver_params *)(corpus->data + corpus->header->header_size + i * corpus->header->record_size);
+}
+
+const FORCESNLPsolver_output *FORCESNLPsolver_corpus_reference(const FORCESNLPsolver_corpus *corpus, size_t i,
+                                                               FORCESNLPsolver_corpus_result *result)
+{
+    const unsigned char *output;
+
+    if( !(corpus->header->flags & FORCESNLPsolver_CORPUS_REFERENCE) ){
+        return NULL;
+    }
+    output = (const unsigned char *)FORCESNLPsolver_corpus_params(corpus, i) + sizeof(FORCESNLPsolver_params);
+    if( result ){
+        memcpy(result, output + sizeof(FORCESNLPsolver_output), sizeof(*result));
+    }
+    return (const FORCESNLPsolver_output *)output;
+}
+
+int FORCESNLPsolver_corpus_append(const char *path, const FORCESNLPsolver_params *params,
+                                  const FORCESNLPsolver_output *output, int exitflag, int iterations)
+{
+    FORCESNLPsolver_corpus_header header, expected;
+    FORCESNLPsolver_corpus_result result;
+    long size;
+    int status = FORCESNLPsolver_CORPUS_OK;
+    FILE *out = fopen(path, "ab+");
+
+    if( !out ){
+        return FORCESNLPsolver_CORPUS_EIO;
+    }
+    fseek(out, 0, SEEK_END);
+    size = ftell(out);
+    if( size <= 0 ){
+        FORCESNLPsolver_corpus_init_header(&header, output != NULL);
+        if( fwrite(&header, sizeof(header), 1, out) != 1 ){
+            status = FORCESNLPsolver_CORPUS_EIO;
+        }
+    } else {
+        fseek(out, 0, SEEK_SET);
+        if( fread(&header, sizeof(header), 1, out) != 1 ){
+            status = FORCESNLPsolver_CORPUS_EFORMAT;
+        } else {
+            status = FORCESNLPsolver_corpus_check_header(&header);
+        }
+        /* records are appended in the layout of this version only */
+        FORCESNLPsolver_corpus_init_header(&expected, output != NULL);
+        if( status == FORCESNLPsolver_CORPUS_OK
+            && (header.version != expected.version || header.flags != expected.flags
+                || header.header_size != expected.header_size || header.record_size != expected.record_size) ){
+            status = FORCESNLPsolver_CORPUS_EMISMATCH;
+        }
+        fseek(out, 0, SEEK_END);
+    }
+
+    if( status == FORCESNLPsolver_CORPUS_OK && fwrite(params, sizeof(*params), 1, out) != 1 ){
+        status = FORCESNLPsolver_CORPUS_EIO;
+    }
+    if( status == FORCESNLPsolver_CORPUS_OK && output ){
+        result.exitflag = exitflag;
+        result.iterations = iterations;
+        if( fwrite(output, sizeof(*output), 1, out) != 1 || fwrite(&result, sizeof(result), 1, out) != 1 ){
+            status = FORCESNLPsolver_CORPUS_EIO;
+        }
+    }
+    if( fclose(out) != 0 && status == FORCESNLPsolver_CORPUS_OK ){
+        status = FORCESNLPsolver_CORPUS_EIO;
+    }
+    return status;
+}
@@ -0,0 +1,105 @@
+/*  * Scenario corpus of FORCESNLPsolver problem instances.
+ *
+ * A corpus file is a 64 byte header followed by fixed-size records:
+ *
+ *   header   magic "FNLPCORP", version, byte order mark, sizes (see below)
+ *   record   xinit[12] x0[1530] all_parameters[170]      as FORCESNLPsolver_params
+ *            [output[1530] exitflag iterations]           if FORCESNLPsolver_CORPUS_REFERENCE
+ *
+ * All values are native doubles and int32, and every record starts on an
+ * 8 byte boundary, so a mapped file is used in place: a record is a
+ * FORCESNLPsolver_params and its reference a FORCESNLPsolver_output. The
+ * number of records follows from the file size, so writers only append.
+ *
+ * Written by FORCESNLPsolver_corpus_append, write_corpus.m and
+ * FORCESNLPsolver_py.FORCESNLPsolver_write_corpus; read by
+ * FORCESNLPsolver_replay.
+ */
+
+#ifndef FORCESNLPSOLVER_CORPUS_H
+#define FORCESNLPSOLVER_CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* inside the block: FORCESNLPsolver.h guards its own with _cplusplus */
+#include "FORCESNLPsolver.h"
+
+#define FORCESNLPsolver_CORPUS_MAGIC "FNLPCORP"
+#define FORCESNLPsolver_CORPUS_VERSION (1)
+#define FORCESNLPsolver_CORPUS_BYTE_ORDER (0x01020304u)
+
+/* header flags */
+#define FORCESNLPsolver_CORPUS_REFERENCE (1u)
+
+/* return codes */
+#define FORCESNLPsolver_CORPUS_OK (0)
+#define FORCESNLPsolver_CORPUS_EIO (-1)        /* cannot open, map or write the file */
+#define FORCESNLPsolver_CORPUS_EFORMAT (-2)    /* not a corpus, or truncated */
+#define FORCESNLPsolver_CORPUS_EVERSION (-3)   /* newer version or other byte order */
+#define FORCESNLPsolver_CORPUS_EMISMATCH (-4)  /* dimensions or flags differ from this solver / file */
+
+typedef struct FORCESNLPsolver_corpus_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;     /* FORCESNLPsolver_CORPUS_BYTE_ORDER as written */
+    uint32_t header_size;    /* bytes before the first record */
+    uint32_t record_size;    /* bytes per record */
+    uint32_t nxinit;         /* 12 */
+    uint32_t nx0;            /* 1530 */
+    uint32_t npar;           /* 170 */
+    uint32_t noutput;        /* 1530 with references, else 0 */
+    uint32_t flags;
+    uint8_t reserved[20];
+} FORCESNLPsolver_corpus_header;
+
+/* reference result stored after the output of a record */
+typedef struct FORCESNLPsolver_corpus_result
+{
+    int32_t exitflag;
+    int32_t iterations;
+} FORCESNLPsolver_corpus_result;
+
+/* a corpus opened for reading */
+typedef struct FORCESNLPsolver_corpus
+{
+    const FORCESNLPsolver_corpus_header *header;
+    size_t count;
+
+    const unsigned char *data;  /* mapped file */
+    size_t size;
+    int mapped;                 /* 0 if read into memory */
+} FORCESNLPsolver_corpus;
+
+/* maps PATH; returns FORCESNLPsolver_CORPUS_OK or an error code */
+extern int FORCESNLPsolver_corpus_open(FORCESNLPsolver_corpus *corpus, const char *path);
+extern void FORCESNLPsolver_corpus_close(FORCESNLPsolver_corpus *corpus);
+
+/* record I, in place */
+extern const FORCESNLPsolver_params *FORCESNLPsolver_corpus_params(const FORCESNLPsolver_corpus *corpus, size_t i);
+
+/* reference output of record I and its exitflag and iterations in RESULT, or NULL without references */
+extern const FORCESNLPsolver_output *FORCESNLPsolver_corpus_reference(const FORCESNLPsolver_corpus *corpus, size_t i,
+                                                                      FORCESNLPsolver_corpus_result *result);
+
+/* appends an instance to PATH, writing the header if the file is new or empty; OUTPUT may be NULL
+ * if the file has no references. Returns FORCESNLPsolver_CORPUS_OK or an error code. */
+extern int FORCESNLPsolver_corpus_append(const char *path, const FORCESNLPsolver_params *params,
+                                         const FORCESNLPsolver_output *output, int exitflag, int iterations);
+
+/* header of a corpus with or without references */
+extern void FORCESNLPsolver_corpus_init_header(FORCESNLPsolver_corpus_header *header, int reference);
+
+/* checks HEADER against this solver; FORCESNLPsolver_CORPUS_OK or an error code */
+extern int FORCESNLPsolver_corpus_check_header(const FORCESNLPsolver_corpus_header *header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FORCESNLPSOLVER_CORPUS_H */
@@ -0,0 +1,80 @@
+/*  * Deadline and cancellation for FORCESNLPsolver.
+ *
+ * The generated solver has no way to be interrupted, but it evaluates the
+ * model through the external function passed to FORCESNLPsolver_solve in
+ * every iteration. FORCESNLPsolver_casadi2forces_deadline wraps the CasADi
+ * adapter and, once the deadline has passed or a cancel was requested,
+ * returns NaN instead of the model values. The solver then stops within one
+ * iteration with exitflag FORCESNLPsolver_BADFUNCEVAL.
+ *
+ * The state is per loaded library, like the solver workspace itself: only
+ * one solve may run per library copy at any time.
+ */
+
+#include <math.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void FORCESNLPsolver_casadi2forces(double *x, double *y, double *l, double *p, double *f, double *nabla_f,
+                                          double *c, double *nabla_c, double *h, double *nabla_h, double *H, int stage);
+
+/* deadline in seconds on the monotonic clock, 0 if none is set */
+static volatile double FORCESNLPsolver_deadline = 0;
+
+/* set from any thread to abort the running solve */
+static volatile int FORCESNLPsolver_cancelled = 0;
+
+static double FORCESNLPsolver_monotonic(void)
+{
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+}
+
+/* arms a deadline SECONDS from now (no deadline if SECONDS <= 0) and clears a pending cancel */
+void FORCESNLPsolver_set_deadline(double seconds)
+{
+    FORCESNLPsolver_deadline = seconds > 0 ? FORCESNLPsolver_monotonic() + seconds : 0;
+    FORCESNLPsolver_cancelled = 0;
+}
+
+/* aborts the running solve at its next function evaluation */
+void FORCESNLPsolver_cancel(void)
+{
+    FORCESNLPsolver_cancelled = 1;
+}
+
+/* returns 1 if the last solve has been stopped by the deadline or a cancel */
+int FORCESNLPsolver_expired(void)
+{
+    return FORCESNLPsolver_cancelled || (FORCESNLPsolver_deadline > 0 && FORCESNLPsolver_monotonic() > FORCESNLPsolver_deadline);
+}
+
+/* CasADi - FORCES interface with deadline check */
+void FORCESNLPsolver_casadi2forces_deadline(double *x, double *y, double *l, double *p, double *f, double *nabla_f,
+                                            double *c, double *nabla_c, double *h, double *nabla_h, double *H, int stage)
+{
+    /* the clock is read once per sweep over the stages */
+    if( stage == 0 && FORCESNLPsolver_expired() ){
+        FORCESNLPsolver_cancelled = 1;
+    }
+    if( FORCESNLPsolver_cancelled ){
+        if( f ){ *f = NAN; }
+        if( c ){ c[0] = NAN; }
+        if( h ){ h[0] = NAN; }
+        return;
+    }
+
+    FORCESNLPsolver_casadi2forces(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, H, stage);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,120 @@
+/*  * Runtime CPU dispatch of the CasADi model and adapter.
+ *
+ * The build compiles FORCESNLPsolver_casadi2forces together with the CasADi
+ * model files once per ISA variant, each under its own symbol suffix
+ * (FORCESNLPsolver_casadi2forces_generic, _avx, _avx2, ...). The exported
+ * FORCESNLPsolver_casadi2forces selects the best variant the running CPU
+ * supports on the first call, so one library runs on every x86-64 host.
+ *
+ * Setting FORCESNLPsolver_ISA=<variant> in the environment forces a variant.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*FORCESNLPsolver_adapter)(double *x, double *y, double *l, double *p, double *f, double *nabla_f,
+                                        double *c, double *nabla_c, double *h, double *nabla_h, double *H, int stage);
+
+#define FORCESNLPsolver_DECLARE_VARIANT(isa) \
+    extern void FORCESNLPsolver_casadi2forces_##isa(double *x, double *y, double *l, double *p, double *f, double *nabla_f, \
+                                                    double *c, double *nabla_c, double *h, double *nabla_h, double *H, int stage);
+
+FORCESNLPsolver_DECLARE_VARIANT(generic)
+#ifdef FORCESNLPsolver_VARIANT_avx
+FORCESNLPsolver_DECLARE_VARIANT(avx)
+#endif
+#ifdef FORCESNLPsolver_VARIANT_avx2
+FORCESNLPsolver_DECLARE_VARIANT(avx2)
+#endif
+#ifdef FORCESNLPsolver_VARIANT_avx512
+FORCESNLPsolver_DECLARE_VARIANT(avx512)
+#endif
+
+/* one entry per variant, best first */
+static const struct
+{
+    const char *name;
+    const char *features[4];
+    FORCESNLPsolver_adapter fn;
+} FORCESNLPsolver_variants[] = {
+#ifdef FORCESNLPsolver_VARIANT_avx512
+    { "avx512", { "avx512f", "avx512dq", "avx2", "fma" }, FORCESNLPsolver_casadi2forces_avx512 },
+#endif
+#ifdef FORCESNLPsolver_VARIANT_avx2
+    { "avx2", { "avx2", "fma", 0, 0 }, FORCESNLPsolver_casadi2forces_avx2 },
+#endif
+#ifdef FORCESNLPsolver_VARIANT_avx
+    { "avx", { "avx", 0, 0, 0 }, FORCESNLPsolver_casadi2forces_avx },
+#endif
+    { "generic", { 0, 0, 0, 0 }, FORCESNLPsolver_casadi2forces_generic }
+};
+
+#define FORCESNLPsolver_NUM_VARIANTS (int)(sizeof(FORCESNLPsolver_variants) / sizeof(FORCESNLPsolver_variants[0]))
+
+static int FORCESNLPsolver_cpu_supports(const char *feature)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    /* __builtin_cpu_supports only accepts string literals */
+    if( !strcmp(feature, "avx") ){ return __builtin_cpu_supports("avx"); }
+    if( !strcmp(feature, "avx2") ){ return __builtin_cpu_supports("avx2"); }
+    if( !strcmp(feature, "fma") ){ return __builtin_cpu_supports("fma"); }
+    if( !strcmp(feature, "avx512f") ){ return __builtin_cpu_supports("avx512f"); }
+    if( !strcmp(feature, "avx512dq") ){ return __builtin_cpu_supports("avx512dq"); }
+#endif
+    (void)feature;
+    return 0;
+}
+
+static int FORCESNLPsolver_selected = -1;
+
+static int FORCESNLPsolver_select(void)
+{
+    const char *forced = getenv("FORCESNLPsolver_ISA");
+    int i, j, ok;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#endif
+    for( i=0; i<FORCESNLPsolver_NUM_VARIANTS; i++ ){
+        ok = 1;
+        for( j=0; j<4 && FORCESNLPsolver_variants[i].features[j]; j++ ){
+            ok = ok && FORCESNLPsolver_cpu_supports(FORCESNLPsolver_variants[i].features[j]);
+        }
+        if( forced && strcmp(forced, FORCESNLPsolver_variants[i].name) ){
+            continue;
+        }
+        if( ok ){
+            return i;
+        }
+    }
+    /* forced variant not built or not supported: fall back to the baseline */
+    return FORCESNLPsolver_NUM_VARIANTS - 1;
+}
+
+/* name of the variant in use, e.g. "avx2" */
+const char* FORCESNLPsolver_isa(void)
+{
+    if( FORCESNLPsolver_selected < 0 ){
+        FORCESNLPsolver_selected = FORCESNLPsolver_select();
+    }
+    return FORCESNLPsolver_variants[FORCESNLPsolver_selected].name;
+}
+
+/* CasADi - FORCES interface, dispatched to the selected variant */
+void FORCESNLPsolver_casadi2forces(double *x, double *y, double *l, double *p, double *f, double *nabla_f,
+                                   double *c, double *nabla_c, double *h, double *nabla_h, double *H, int stage)
+{
+    /* selection is idempotent, so a race on the first call is harmless */
+    if( FORCESNLPsolver_selected < 0 ){
+        FORCESNLPsolver_selected = FORCESNLPsolver_select();
+    }
+    FORCESNLPsolver_variants[FORCESNLPsolver_selected].fn(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, H, stage);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
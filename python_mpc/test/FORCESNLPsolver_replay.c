@@ -0,0 +1,178 @@
+/*  * Replays recorded problem instances through FORCESNLPsolver.
+ *
+ * Used as the training run of the profile-guided build (cmake/FastMpcPgo.cmake).
+ *
+ *   FORCESNLPsolver_replay [corpus ...]
+ *
+ * A corpus file is either in the format of FORCESNLPsolver_corpus.h, which is
+ * mapped and solved in place, or a legacy sequence of raw
+ * FORCESNLPsolver_params records (xinit, x0, all_parameters as native
+ * doubles). Where a corpus holds reference outputs, the exitflags and the
+ * largest deviation from them are reported. Without arguments, the initial
+ * conditions of two_abstacles.m are replayed together with deterministic
+ * perturbations.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FORCESNLPsolver.h"
+#include "FORCESNLPsolver_corpus.h"
+
+extern void FORCESNLPsolver_casadi2forces(double *x, double *y, double *l, double *p, double *f, double *nabla_f,
+                                          double *c, double *nabla_c, double *h, double *nabla_h, double *H, int stage);
+
+/* number of perturbed copies of each built-in scenario */
+#define REPLAY_PERTURBATIONS (8)
+
+static FORCESNLPsolver_params params;
+static FORCESNLPsolver_output output;
+static FORCESNLPsolver_info info;
+
+static int solves;
+static int optimal;
+
+/* comparison with reference outputs */
+static int compared;
+static int exitflag_mismatches;
+static double max_deviation;
+
+static int replay_solve_params(FORCESNLPsolver_params *instance, FILE *fs)
+{
+    int exitflag = FORCESNLPsolver_solve(instance, &output, &info, fs, FORCESNLPsolver_casadi2forces);
+    solves++;
+    if( exitflag == FORCESNLPsolver_OPTIMAL ){
+        optimal++;
+    }
+    return exitflag;
+}
+
+static void replay_solve(FILE *fs)
+{
+    replay_solve_params(&params, fs);
+}
+
+/* initial guess and parameters of two_abstacles.m */
+static void replay_defaults(void)
+{
+    static const double lb[18] = { -5,-1,-0.01,-1,-0.01,-1, -3,-1,0,-M_PI, -3,0,0,-M_PI, -3,0,0,-M_PI };
+    static const double ub[18] = { +5,+1,+0.01,+1,+0.01,+1, 3,3,1,+M_PI, 3,3,1,+M_PI, 3,3,1,+M_PI };
+    int i, k;
+
+    for( k=0; k<85; k++ ){
+        for( i=0; i<18; i++ ){
+            params.x0[18*k + i] = lb[i] + (ub[i] - lb[i])/2;
+        }
+        params.all_parameters[2*k] = 1;     /* m */
+        params.all_parameters[2*k + 1] = 1; /* I */
+    }
+}
+
+static void replay_builtin(FILE *fs)
+{
+    static const double xinit[2][12] = {
+        { -1.5, 0, 0.55, M_PI/2, -1, 1.11, 0.1, M_PI/4, -2, 0, 0.5, M_PI/2 },
+        { -1.5, 0, 0.5,  M_PI/2, -1, 1.11, 0.1, M_PI/4, -2, 0, 0.5, M_PI/2 } };
+    unsigned int seed = 1;
+    int s, r, i;
+
+    replay_defaults();
+    for( s=0; s<2; s++ ){
+        for( r=0; r<=REPLAY_PERTURBATIONS; r++ ){
+            for( i=0; i<12; i++ ){
+                /* small reproducible perturbation of positions, speeds and headings */
+                seed = seed * 1103515245u + 12345u;
+                params.xinit[i] = xinit[s][i] + (r ? 0.02 * ((double)((seed >> 16) & 0x7fff) / 0x7fff - 0.5) : 0);
+            }
+            replay_solve(fs);
+        }
+    }
+}
+
+static void replay_compare(const FORCESNLPsolver_output *reference, const FORCESNLPsolver_corpus_result *result,
+                           int exitflag)
+{
+    const double *z = (const double *)&output;
+    const double *r = (const double *)reference;
+    size_t i;
+
+    compared++;
+    if( exitflag != result->exitflag ){
+        exitflag_mismatches++;
+    }
+    for( i=0; i<sizeof(output)/sizeof(double); i++ ){
+        if( fabs(z[i] - r[i]) > max_deviation ){
+            max_deviation = fabs(z[i] - r[i]);
+        }
+    }
+}
+
+static int replay_corpus(const char *path, FILE *fs)
+{
+    FORCESNLPsolver_corpus corpus;
+    FORCESNLPsolver_corpus_result result;
+    const FORCESNLPsolver_output *reference;
+    size_t i;
+    int exitflag;
+    int status = FORCESNLPsolver_corpus_open(&corpus, path);
+
+    if( status != FORCESNLPsolver_CORPUS_OK ){
+        fprintf(stderr, "FORCESNLPsolver_replay: cannot read %s (error %d)\n", path, status);
+        return 0;
+    }
+    for( i=0; i<corpus.count; i++ ){
+        /* the mapping is private, so the record is solved in place */
+        exitflag = replay_solve_params((FORCESNLPsolver_params *)FORCESNLPsolver_corpus_params(&corpus, i), fs);
+        reference = FORCESNLPsolver_corpus_reference(&corpus, i, &result);
+        if( reference ){
+            replay_compare(reference, &result, exitflag);
+        }
+    }
+    FORCESNLPsolver_corpus_close(&corpus);
+    return 1;
+}
+
+static int replay_file(const char *path, FILE *fs)
+{
+    char magic[8];
+    FILE *in = fopen(path, "rb");
+    if( !in ){
+        fprintf(stderr, "FORCESNLPsolver_replay: cannot open %s\n", path);
+        return 0;
+    }
+    if( fread(magic, sizeof(magic), 1, in) == 1 && memcmp(magic, FORCESNLPsolver_CORPUS_MAGIC, sizeof(magic)) == 0 ){
+        fclose(in);
+        return replay_corpus(path, fs);
+    }
+    rewind(in);
+    while( fread(&params, sizeof(params), 1, in) == 1 ){
+        replay_solve(fs);
+    }
+    fclose(in);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *fs = fopen("/dev/null", "w");
+    int i, ok = 1;
+
+    if( argc < 2 ){
+        replay_builtin(fs);
+    }
+    for( i=1; i<argc; i++ ){
+        ok = replay_file(argv[i], fs) && ok;
+    }
+    if( fs ){
+        fclose(fs);
+    }
+
+    printf("replayed %d solves, %d optimal\n", solves, optimal);
+    if( compared ){
+        printf("compared %d with references: %d exitflag mismatches, max deviation %g\n",
+               compared, exitflag_mismatches, max_deviation);
+    }
+    return ok ? 0 : 1;
+}
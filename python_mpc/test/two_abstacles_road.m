@@ -0,0 +1,121 @@
+% two_abstacles.m with the road taken from the parameters.
+%--------------------------------------------------------------------------
+%
+% Instead of the annulus around the origin, the lane is described per stage
+% by a point of its centerline, p = [m I xr yr theta kappa left right]: the
+% position, heading and curvature of the centerline near the stage and the
+% distances of the lane edges to its left and right. The Frenet coordinates
+% of the ego car follow from the second order expansion around that point,
+%   lon = t'(p - pr), lat = n'(p - pr)
+%   s = lon (1 + kappa lat),  d = lat - kappa lon^2 / 2
+% The stage cost keeps the car on the centerline and -right <= d <= left
+% bounds the lane, so the road can change at runtime through
+% all_parameters without regenerating the solver.
+%
+% The C++ counterpart, which builds the centerline from waypoints and fills
+% these parameters, is mpc_planner/include/mpc_planner/reference_path.h.
+%
+% See also two_abstacles.m, FORCES_NLP
+
+clear; clc; close all;
+deg2rad = @(deg) deg/180*pi; % convert degrees into radians
+
+%% Problem dimensions
+model.N = 85;           % horizon length
+model.nvar = 18;        % number of variables
+model.neq  = 12;        % number of equality constraints
+model.nh = 6;           % number of inequality constraint functions
+model.npar = 8;         % number of parameters: [m I xr yr theta kappa left right]
+
+%% Road geometry of a stage
+lon = @(z,p) cos(p(5))*(z(7)-p(3)) + sin(p(5))*(z(8)-p(4));
+lat = @(z,p) -sin(p(5))*(z(7)-p(3)) + cos(p(5))*(z(8)-p(4));
+lateral = @(z,p) lat(z,p) - p(6)*lon(z,p)^2/2;
+
+%% Objective function
+% 3*d approximates the (x^2+y^2-2.25) of the annulus near radius 1.5
+model.objective = @(z,p) 0.1*(z(1)^2 + 0.1*z(2)^2 + z(3)^2 + 0.1*z(4)^2 + z(6)^2 + 0.1*z(5)^2 + 0.1*(3*lateral(z,p))^2);
+model.objectiveN = @(z) 100*(z(7)-1.5)^2 + 100*(z(8)-0)^2;
+
+%% Dynamics
+integrator_stepsize = 0.1;
+m=1; I=1; % physical constants of the model
+continuous_dynamics = @(x,u,p) [x(3)*cos(x(4));  % v*cos(theta)
+                                x(3)*sin(x(4));  % v*sin(theta)
+                                u(1)/p(1);       % F/m
+                                u(2)/p(2);       % s/I
+                                x(7)*cos(x(8));  % x_obst=v*cos(theta)
+                                x(7)*sin(x(8));  % y_obst=v*sin(theta)
+                                u(3);            % F_obst
+                                u(4);            % s_obst
+                                x(11)*cos(x(12));  % x_obst=v*cos(theta)
+                                x(11)*sin(x(12));  % y_obst=v*sin(theta)
+                                u(5);            % F_obst
+                                u(6)];
+model.eq = @(z,p) RK4( z(7:18), z(1:6), continuous_dynamics, integrator_stepsize, p);
+model.E = [zeros(12,6), eye(12)];
+
+%% Inequality constraints: the lane, then the obstacles as in two_abstacles.m
+model.lb = [ -5,-1,-0.01,-1,-0.01,-1,-3, -1, 0, -pi, -3 0 0 -pi,-3 0 0 -pi];
+model.ub = [ +5,+1,+0.01,+1, +0.01,+1,  3, 3, 1, +pi,  3 3 1 +pi, 3 3 1 +pi];
+
+obstacle_ellipse = @(z,xo,yo,r2) ((cos(atan2(-2*xo/(2*(r2-xo^2)),1))*(z(7)-xo)+sin(atan2(-2*xo/(2*(r2-xo^2)),1))*(z(8)-yo))^2)/((0.3+z(9))^2) ...
+                               + ((sin(atan2(-2*xo/(2*(r2-xo^2)),1))*(z(7)-xo)-cos(atan2(-2*xo/(2*(r2-xo^2)),1))*(z(8)-yo))^2)/(0.25);
+model.ineq = @(z,p) [lateral(z,p) + p(8);
+                   p(7) - lateral(z,p);
+                   (z(11)^2+z(12)^2-2.25);
+                   (z(15)^2+z(16)^2-4);
+                   obstacle_ellipse(z, z(11), z(12), 2.25);
+                   obstacle_ellipse(z, z(15), z(16), 4)];
+model.hu = [inf,inf,0.1,0.1,inf,inf];
+model.hl = [0,0,-0.1,-0.1,1,1];
+
+%% Initial conditions
+model.xinit = [-1.5, 0, 0.5, deg2rad(90),-1, 1.11, 0.1, deg2rad(45),-2, 0, 0.5, deg2rad(90)]';
+model.xinitidx = 7:18;
+
+%% Define solver options
+codeoptions = getOptions('FORCESNLPsolver_road');
+codeoptions.maxit = 3000;    % Maximum number of iterations
+codeoptions.printlevel = 2;
+codeoptions.optlevel = 2;
+codeoptions.noVariableElimination = 1;
+codeoptions.nlp.lightCasadi = 1;
+
+%% Generate forces solver
+FORCES_NLP(model, codeoptions);
+
+%% Road
+% The annulus of two_abstacles.m: centerline of radius 1.5, driven clockwise
+% from (-1.5, 0), lane edges at radius sqrt(2) and 3. The road point of each
+% stage advances along the half circle to the goal.
+radius = 1.5;
+s = linspace(0, pi*radius, model.N);
+phi = pi - s/radius;
+road = [radius*cos(phi); radius*sin(phi); phi - pi/2; -ones(1,model.N)/radius;
+        (3 - radius)*ones(1,model.N); (radius - sqrt(2))*ones(1,model.N)];
+
+%% Call solver
+x0i = model.lb+(model.ub-model.lb)/2;
+problem.x0 = repmat(x0i',model.N,1);
+problem.xinit = model.xinit;
+problem.all_parameters = reshape([repmat([m; I], 1, model.N); road], [], 1);
+
+[output,exitflag,info] = FORCESNLPsolver_road(problem);
+fprintf('\nexitflag %d .\n',exitflag);
+fprintf('\nFORCES took %d iterations and %f seconds to solve the problem.\n',info.it,info.solvetime);
+assert(exitflag == 1,'Some problem in FORCES solver');
+
+%% Plot results
+TEMP = zeros(model.nvar,model.N);
+for i=1:model.N
+    TEMP(:,i) = output.(['x',sprintf('%02d',i)]);
+end
+X = TEMP(7:18,:);
+t = integrator_stepsize*(0:model.N-1);
+
+figure(1); clf;
+scatter(X(1,:),X(2,:),14,t,'filled'); hold on;
+plot(X(5,:),X(6,:),'g.'); plot(X(9,:),X(10,:),'m.'); plot(road(1,:),road(2,:),'k--');
+colorbar; box on
+title('position (color: time)'); xlim([-3 3]); ylim([0 3]); xlabel('x position'); ylabel('y position');
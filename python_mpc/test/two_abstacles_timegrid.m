@@ -0,0 +1,113 @@
+% two_abstacles.m on a non-uniform time grid.
+%--------------------------------------------------------------------------
+%
+% The RK4 step of every stage is a parameter, p = [m I dt], instead of the
+% fixed integrator_stepsize. The grid is fine near the vehicle and grows
+% geometrically towards the end of the horizon, so the same lookahead is
+% covered with fewer stages. The stage cost is weighed with dt/0.1, which
+% keeps it comparable to the uniform grid.
+%
+% The solver is generated for model.N stages; fewer can be used at runtime
+% by setting dt = 0 on the stages past the active ones: their states repeat
+% the last active one, so the terminal cost still applies to it, and their
+% cost vanishes but for a small regularization of the free inputs.
+%
+% The C++ counterpart of the grid is mpc_planner/include/mpc_planner/time_grid.h.
+%
+% See also two_abstacles.m, FORCES_NLP
+
+clear; clc; close all;
+deg2rad = @(deg) deg/180*pi; % convert degrees into radians
+
+%% Problem dimensions
+model.N = 85;           % horizon length (the most stages usable at runtime)
+model.nvar = 18;        % number of variables
+model.neq  = 12;        % number of equality constraints
+model.nh = 5;           % number of inequality constraint functions
+model.npar = 3;         % number of parameters: [m I dt]
+
+%% Objective function, weighed with the stage length
+nominal_stepsize = 0.1;
+stage_cost = @(z) 0.1*(z(1)^2 + 0.1*z(2)^2 + z(3)^2 + 0.1*z(4)^2 + z(6)^2 + 0.1*z(5)^2 + 0.1*(z(7)^2+z(8)^2-2.25)^2);
+model.objective = @(z,p) (p(3)/nominal_stepsize + 1e-3)*stage_cost(z);
+model.objectiveN = @(z) 100*(z(7)-1.5)^2 + 100*(z(8)-0)^2;
+
+%% Dynamics, with the step size of the stage
+m=1; I=1; % physical constants of the model
+continuous_dynamics = @(x,u,p) [x(3)*cos(x(4));  % v*cos(theta)
+                                x(3)*sin(x(4));  % v*sin(theta)
+                                u(1)/p(1);       % F/m
+                                u(2)/p(2);       % s/I
+                                x(7)*cos(x(8));  % x_obst=v*cos(theta)
+                                x(7)*sin(x(8));  % y_obst=v*sin(theta)
+                                u(3);            % F_obst
+                                u(4);            % s_obst
+                                x(11)*cos(x(12));  % x_obst=v*cos(theta)
+                                x(11)*sin(x(12));  % y_obst=v*sin(theta)
+                                u(5);            % F_obst
+                                u(6)];
+model.eq = @(z,p) RK4( z(7:18), z(1:6), continuous_dynamics, p(3), p);
+model.E = [zeros(12,6), eye(12)];
+
+%% Inequality constraints, as in two_abstacles.m
+model.lb = [ -5,-1,-0.01,-1,-0.01,-1,-3, -1, 0, -pi, -3 0 0 -pi,-3 0 0 -pi];
+model.ub = [ +5,+1,+0.01,+1, +0.01,+1,  3, 3, 1, +pi,  3 3 1 +pi, 3 3 1 +pi];
+
+obstacle_ellipse = @(z,xo,yo,r2) ((cos(atan2(-2*xo/(2*(r2-xo^2)),1))*(z(7)-xo)+sin(atan2(-2*xo/(2*(r2-xo^2)),1))*(z(8)-yo))^2)/((0.3+z(9))^2) ...
+                               + ((sin(atan2(-2*xo/(2*(r2-xo^2)),1))*(z(7)-xo)-cos(atan2(-2*xo/(2*(r2-xo^2)),1))*(z(8)-yo))^2)/(0.25);
+model.ineq = @(z) [z(7)^2 + z(8)^2;
+                   (z(11)^2+z(12)^2-2.25);
+                   (z(15)^2+z(16)^2-4);
+                   obstacle_ellipse(z, z(11), z(12), 2.25);
+                   obstacle_ellipse(z, z(15), z(16), 4)];
+model.hu = [9,0.1,0.1,inf,inf];
+model.hl = [2,-0.1,-0.1,1,1];
+
+%% Initial conditions
+model.xinit = [-1.5, 0, 0.5, deg2rad(90),-1, 1.11, 0.1, deg2rad(45),-2, 0, 0.5, deg2rad(90)]';
+model.xinitidx = 7:18;
+
+%% Define solver options
+codeoptions = getOptions('FORCESNLPsolver_timegrid');
+codeoptions.maxit = 3000;    % Maximum number of iterations
+codeoptions.printlevel = 2;
+codeoptions.optlevel = 2;
+codeoptions.noVariableElimination = 1;
+codeoptions.nlp.lightCasadi = 1;
+
+%% Generate forces solver
+FORCES_NLP(model, codeoptions);
+
+%% Time grid
+% 40 active stages, 0.05 s at the vehicle, growing geometrically to span the
+% 8.4 s of the uniform grid (make_time_grid in time_grid.h).
+stages = 40; first_step = 0.05; horizon = nominal_stepsize*(model.N-1);
+span = @(ratio) first_step*sum(ratio.^(0:stages-2));
+ratio = fzero(@(r) span(r) - horizon, [1 2]);
+dt = zeros(1, model.N);
+dt(1:stages-1) = first_step*ratio.^(0:stages-2);
+
+%% Call solver
+x0i = model.lb+(model.ub-model.lb)/2;
+problem.x0 = repmat(x0i',model.N,1);
+problem.xinit = model.xinit;
+problem.all_parameters = reshape([repmat([m; I], 1, model.N); dt], [], 1);
+
+[output,exitflag,info] = FORCESNLPsolver_timegrid(problem);
+fprintf('\nexitflag %d .\n',exitflag);
+fprintf('\nFORCES took %d iterations and %f seconds to solve the problem.\n',info.it,info.solvetime);
+assert(exitflag == 1,'Some problem in FORCES solver');
+
+%% Plot results
+TEMP = zeros(model.nvar,model.N);
+for i=1:model.N
+    TEMP(:,i) = output.(['x',sprintf('%02d',i)]);
+end
+X = TEMP(7:18,1:stages);
+t = [0 cumsum(dt(1:stages-1))];
+
+figure(1); clf;
+scatter(X(1,:),X(2,:),14,t,'filled'); hold on;
+plot(X(5,:),X(6,:),'g.'); plot(X(9,:),X(10,:),'m.');
+colorbar; box on
+title('position (color: time)'); xlim([-3 3]); ylim([0 3]); xlabel('x position'); ylabel('y position');
@@ -0,0 +1,122 @@
+% two_obstacles_ego.m with exact rectangle-to-rectangle avoidance.
+%--------------------------------------------------------------------------
+%
+% The ellipses around the obstacles are replaced by the dual formulation of
+% the distance between the rectangular footprints (OBCA): per obstacle the
+% stage carries the multipliers lambda (4, one per obstacle face) and mu+
+% (2) of a separating hyperplane, and
+%   (A p - b)' lambda - g' mu >= dmin,  |A' lambda|^2 <= 1,  mu+ + R' A' lambda >= 0
+% where mu = [mu+; mu+ + R' A' lambda] eliminates the equality of the dual
+% problem. The multipliers are local to their stage, so they enlarge the
+% stage blocks without coupling stages.
+%
+% Variables are collected stage-wise into
+%   z = [F s x y v theta | lambda1 mu1 | lambda2 mu2]
+% and the parameters are those of two_obstacles_ego.m. The C++ counterpart,
+% with the rows in the layout of the external function and a warm start of
+% the multipliers, is mpc_planner/include/mpc_planner/polygon_avoidance.h.
+%
+% See also two_obstacles_ego.m, FORCES_NLP
+
+clear; clc; close all;
+deg2rad = @(deg) deg/180*pi; % convert degrees into radians
+
+%% Problem dimensions
+model.N = 85;           % horizon length
+model.nvar = 18;        % number of variables: 6 of the car, 6 multipliers per obstacle
+model.neq  = 4;         % number of equality constraints
+model.nh = 9;           % number of inequality constraint functions
+model.npar = 8;         % number of parameters
+
+%% Objective function
+model.objective = @(z) 0.1*(z(1)^2 + 0.1*z(2)^2 + 0.1*(z(3)^2+z(4)^2-2.25)^2);
+model.objectiveN = @(z) 100*(z(3)-1.5)^2 + 100*(z(4)-0)^2;
+
+%% Dynamics, i.e. equality constraints
+m=1; I=1; % physical constants of the model
+integrator_stepsize = 0.1;
+continuous_dynamics = @(x,u,p) [x(3)*cos(x(4));  % v*cos(theta)
+                                x(3)*sin(x(4));  % v*sin(theta)
+                                u(1)/p(1);       % F/m
+                                u(2)/p(2)];      % s/I
+model.eq = @(z,p) RK4( z(3:6), z(1:2), continuous_dynamics, integrator_stepsize, p);
+model.E = [zeros(4,2), eye(4)];
+
+%% Inequality constraints
+%             F   s | x  y  v theta
+%             F   s | x  y  v theta | lambda1  mu1 | lambda2  mu2
+model.lb = [ -5, -1, -3, -1, 0, -pi,  zeros(1,12)];
+model.ub = [ +5, +1,  3,  3, 1, +pi,  ones(1,12)];
+
+% Footprints as half length and half width, obstacle faces ordered
+% +heading, +left, -heading, -left
+ego_size = [0.25; 0.12]; obstacle_size = [0.25; 0.12]; dmin = 0.05;
+rot = @(t) [cos(t) -sin(t); sin(t) cos(t)];
+obstacle_A = @(o) [rot(o(3))'; -rot(o(3))'];
+obstacle_b = @(o) [obstacle_size; obstacle_size] + obstacle_A(o)*o(1:2);
+obca = @(z,o,d) [(obstacle_A(o)*z(3:4) - obstacle_b(o))'*d(1:4) ...
+                    - ego_size'*(2*d(5:6) + rot(z(6))'*obstacle_A(o)'*d(1:4));
+                 sum((obstacle_A(o)'*d(1:4)).^2);
+                 d(5:6) + rot(z(6))'*obstacle_A(o)'*d(1:4)];
+model.ineq = @(z,p) [z(3)^2 + z(4)^2;
+                     obca(z, p(3:5), z(7:12));
+                     obca(z, p(6:8), z(13:18))];
+model.hu = [9, inf, 1, inf, inf, inf, 1, inf, inf];
+model.hl = [2, dmin, -inf, 0, 0, dmin, -inf, 0, 0];
+
+%% Initial conditions
+model.xinit = [-1.5, 0, 0.5, deg2rad(90)]';
+model.xinitidx = 3:6;
+
+%% Define solver options
+codeoptions = getOptions('FORCESNLPsolver_obca');
+codeoptions.maxit = 3000;    % Maximum number of iterations
+codeoptions.printlevel = 2;
+codeoptions.optlevel = 2;
+codeoptions.noVariableElimination = 1;
+codeoptions.nlp.lightCasadi = 1;
+
+%% Generate forces solver
+FORCES_NLP(model, codeoptions);
+
+%% Predict the obstacles
+% Constant speed and heading from their initial states in two_abstacles.m,
+% the same prediction predict_obstacles (obstacle_predictor.h) does in C++.
+obstacles = [-1, 1.11, 0.1, deg2rad(45);
+             -2, 0,    0.5, deg2rad(90)]';
+obstacle_dynamics = @(x,u,p) [x(3)*cos(x(4)); x(3)*sin(x(4)); 0; 0];
+all_parameters = zeros(model.npar, model.N);
+for k=1:model.N
+    all_parameters(:,k) = [m; I; obstacles([1 2 4],1); obstacles([1 2 4],2)];
+    for i=1:2
+        obstacles(:,i) = RK4(obstacles(:,i), [0 0]', obstacle_dynamics, integrator_stepsize, []);
+    end
+end
+
+%% Call solver
+x0i = model.lb+(model.ub-model.lb)/2;
+problem.x0 = repmat(x0i',model.N,1);
+problem.xinit = model.xinit;
+problem.all_parameters = all_parameters(:);
+
+[output,exitflag,info] = FORCESNLPsolver_obca(problem);
+fprintf('\nexitflag %d .\n',exitflag);
+fprintf('\nFORCES took %d iterations and %f seconds to solve the problem.\n',info.it,info.solvetime);
+assert(exitflag == 1,'Some problem in FORCES solver');
+
+%% Plot results
+TEMP = zeros(model.nvar,model.N);
+for i=1:model.N
+    TEMP(:,i) = output.(['x',sprintf('%02d',i)]);
+end
+X = TEMP(3:6,:);
+
+figure(1); clf;
+plot(X(1,:),X(2,:),'b.-'); hold on;
+plot(all_parameters(3,:),all_parameters(4,:),'g.');
+plot(all_parameters(6,:),all_parameters(7,:),'m.');
+rectangle('Position',[-sqrt(model.hl(1)) -sqrt(model.hl(1)) 2*sqrt(model.hl(1)) 2*sqrt(model.hl(1))],'Curvature',[1 1],'EdgeColor','r','LineStyle',':');
+rectangle('Position',[-sqrt(model.hu(1)) -sqrt(model.hu(1)) 2*sqrt(model.hu(1)) 2*sqrt(model.hu(1))],'Curvature',[1 1],'EdgeColor','r','LineStyle',':');
+box on
+legend({'autonomous car','obstacle1','obstacle2'},'FontSize',8,'FontWeight','bold','Location','best')
+title('position'); xlim([-3 3]); ylim([0 3]); xlabel('x position'); ylabel('y position');
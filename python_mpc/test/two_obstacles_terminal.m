@@ -0,0 +1,155 @@
+% two_obstacles_tracking.m with an LQR terminal cost and terminal set.
+%--------------------------------------------------------------------------
+%
+% The last stage is charged the cost-to-go 1/2 e'Pe, e = x - x_ref, of the
+% LQR controller of the car linearized around the terminal reference, and
+% constrained to the level set e'Pe <= alpha in which that controller
+% respects the bounds. With this terminal ingredient the horizon shrinks
+% from 85 to 30 stages. P enters as its Cholesky factor L (P = LL'), packed
+% by columns after the tracking parameters,
+%   p = [... tracking (22) | L (10) | alpha]
+% so it is recomputed at runtime for every new reference. Stages before the
+% last have L = 0 and alpha = 1, which disables the terminal rows.
+%
+% The C++ counterpart, which solves the Riccati equation and fills these
+% parameters, is mpc_planner/include/mpc_planner/terminal_cost.h.
+%
+% See also two_obstacles_tracking.m, FORCES_NLP
+
+clear; clc; close all;
+deg2rad = @(deg) deg/180*pi; % convert degrees into radians
+
+%% Problem dimensions
+model.N = 30;           % horizon length
+model.nvar = 6;         % number of variables
+model.neq  = 4;         % number of equality constraints
+model.nh = 4;           % number of inequality constraint functions
+model.npar = 33;        % number of parameters: 22 of two_obstacles_tracking.m, 11 of the terminal cost
+
+%% Objective function, least squares in the tracking parameters
+tracking_residual = @(z,p) [sqrt(p(15:20)).*(z - p(9:14));
+                            sqrt(p(22))*(z(3)^2 + z(4)^2 - p(21)^2)];
+terminal_factor = @(l) [l(1) 0 0 0; l(2) l(5) 0 0; l(3) l(6) l(8) 0; l(4) l(7) l(9) l(10)];
+terminal_residual = @(z,p) terminal_factor(p(23:32))'*(z(3:6) - p(11:14));
+model.LSobjective = tracking_residual;
+model.LSobjectiveN = @(z,p) [tracking_residual(z,p); terminal_residual(z,p)];
+
+%% Dynamics, i.e. equality constraints
+m=1; I=1; % physical constants of the model
+integrator_stepsize = 0.1;
+continuous_dynamics = @(x,u,p) [x(3)*cos(x(4));  % v*cos(theta)
+                                x(3)*sin(x(4));  % v*sin(theta)
+                                u(1)/p(1);       % F/m
+                                u(2)/p(2)];      % s/I
+model.eq = @(z,p) RK4( z(3:6), z(1:2), continuous_dynamics, integrator_stepsize, p);
+model.E = [zeros(4,2), eye(4)];
+
+%% Inequality constraints
+%             F   s | x  y  v theta
+model.lb = [ -5, -1, -3, -1, 0, -pi];
+model.ub = [ +5, +1,  3,  3, 1, +pi];
+
+% Ellipse around each obstacle, aligned with its heading and stretched with
+% the ego speed, as in two_abstacles.m
+obstacle_ellipse = @(z,o) ((cos(o(3))*(z(3)-o(1))+sin(o(3))*(z(4)-o(2)))^2)/((0.3+z(5))^2) ...
+                        + ((sin(o(3))*(z(3)-o(1))-cos(o(3))*(z(4)-o(2)))^2)/(0.25);
+model.ineq = @(z,p) [z(3)^2 + z(4)^2;
+                     obstacle_ellipse(z, p(3:5));
+                     obstacle_ellipse(z, p(6:8));
+                     sum(terminal_residual(z,p).^2) - p(33)];  % terminal set
+model.hu = [9,inf,inf,0];
+model.hl = [2,1,1,-inf];
+
+%% Initial conditions
+model.xinit = [-1.5, 0, 0.5, deg2rad(90)]';
+model.xinitidx = 3:6;
+
+%% Define solver options
+codeoptions = getOptions('FORCESNLPsolver_terminal');
+codeoptions.maxit = 3000;    % Maximum number of iterations
+codeoptions.printlevel = 2;
+codeoptions.optlevel = 2;
+codeoptions.noVariableElimination = 1;
+codeoptions.nlp.lightCasadi = 1;
+codeoptions.nlp.hessian_approximation = 'gauss-newton';
+
+%% Generate forces solver
+FORCES_NLP(model, codeoptions);
+
+%% Predict the obstacles
+% Constant speed and heading from their initial states in two_abstacles.m,
+% the same prediction predict_obstacles (obstacle_predictor.h) does in C++.
+obstacles = [-1, 1.11, 0.1, deg2rad(45);
+             -2, 0,    0.5, deg2rad(90)]';
+obstacle_dynamics = @(x,u,p) [x(3)*cos(x(4)); x(3)*sin(x(4)); 0; 0];
+all_parameters = zeros(8, model.N);
+for k=1:model.N
+    all_parameters(:,k) = [m; I; obstacles([1 2 4],1); obstacles([1 2 4],2)];
+    for i=1:2
+        obstacles(:,i) = RK4(obstacles(:,i), [0 0]', obstacle_dynamics, integrator_stepsize, []);
+    end
+end
+
+%% Tracking references
+% Inputs and lane on every stage (lane_reference in C++); the terminal cost
+% below replaces the pull to a fixed goal.
+lane = [zeros(6,1); 0.2; 0.02; 0; 0; 0; 0; 1.5; 0.02];
+all_parameters = [all_parameters; repmat(lane, 1, model.N)];
+
+%% Terminal ingredients
+% LQR of the RK4 discretization around the point of the lane reached at
+% 0.5 m/s by the end of the horizon, the C++ terminal_ingredients with its
+% default weights.
+phi = pi - 0.5*integrator_stepsize*(model.N-1)/1.5;
+x_ref = [1.5*cos(phi); 1.5*sin(phi); 0.5; phi - pi/2]; u_ref = [0; 0];
+step = @(x,u) RK4(x, u, continuous_dynamics, integrator_stepsize, [m I]);
+A = zeros(4); B = zeros(4,2); d = 1e-6;
+for i=1:4
+    e = zeros(4,1); e(i) = d;
+    A(:,i) = (step(x_ref+e, u_ref) - step(x_ref-e, u_ref))/(2*d);
+end
+for i=1:2
+    e = zeros(2,1); e(i) = d;
+    B(:,i) = (step(x_ref, u_ref+e) - step(x_ref, u_ref-e))/(2*d);
+end
+[K,P] = dlqr(A, B, diag([1 1 0.1 0.1]), diag([0.2 0.02]));
+
+% largest level set of e'Pe in which u = u_ref - K e and x stay within the
+% bounds, halved for the linearization error
+G = [-K; eye(4)]; center = [u_ref; x_ref];
+margin = min(model.ub(1:6)' - center, center - model.lb(1:6)');
+alpha = 0.5*min(margin.^2 ./ sum((G/P).*G, 2));
+
+L = chol(P, 'lower');
+all_parameters = [all_parameters; zeros(10, model.N); ones(1, model.N)];
+all_parameters(9:14, model.N) = [u_ref; x_ref];
+all_parameters(23:32, model.N) = L(tril(true(4)));
+all_parameters(33, model.N) = alpha;
+
+%% Call solver
+x0i = model.lb+(model.ub-model.lb)/2;
+problem.x0 = repmat(x0i',model.N,1);
+problem.xinit = model.xinit;
+problem.all_parameters = all_parameters(:);
+
+[output,exitflag,info] = FORCESNLPsolver_terminal(problem);
+fprintf('\nexitflag %d .\n',exitflag);
+fprintf('\nFORCES took %d iterations and %f seconds to solve the problem.\n',info.it,info.solvetime);
+assert(exitflag == 1,'Some problem in FORCES solver');
+
+%% Plot results
+TEMP = zeros(model.nvar,model.N);
+for i=1:model.N
+    TEMP(:,i) = output.(['x',sprintf('%02d',i)]);
+end
+X = TEMP(3:6,:);
+
+figure(1); clf;
+plot(X(1,:),X(2,:),'b.-'); hold on;
+plot(all_parameters(3,:),all_parameters(4,:),'g.');
+plot(all_parameters(6,:),all_parameters(7,:),'m.');
+rectangle('Position',[-sqrt(model.hl(1)) -sqrt(model.hl(1)) 2*sqrt(model.hl(1)) 2*sqrt(model.hl(1))],'Curvature',[1 1],'EdgeColor','r','LineStyle',':');
+rectangle('Position',[-sqrt(model.hu(1)) -sqrt(model.hu(1)) 2*sqrt(model.hu(1)) 2*sqrt(model.hu(1))],'Curvature',[1 1],'EdgeColor','r','LineStyle',':');
+box on
+legend({'autonomous car','obstacle1','obstacle2'},'FontSize',8,'FontWeight','bold','Location','best')
+title('position'); xlim([-3 3]); ylim([0 3]); xlabel('x position'); ylabel('y position');
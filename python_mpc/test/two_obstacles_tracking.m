@@ -0,0 +1,120 @@
+% two_obstacles_ego.m with the tracking cost taken from the parameters.
+%--------------------------------------------------------------------------
+%
+% The lane radius and the terminal target are no longer compiled in. Each
+% stage reads a reference z_ref, weights q and a lane, appended to the
+% parameters of two_obstacles_ego.m,
+%   p = [m I x1 y1 theta1 x2 y2 theta2 | z_ref (6) | q (6) | r_lane w_lane]
+% and the cost is the least squares of the residuals
+%   r = [sqrt(q).*(z - z_ref); sqrt(w_lane)*(x^2 + y^2 - r_lane^2)]
+% solved with the Gauss-Newton Hessian. The terminal stage is an ordinary
+% stage whose parameters pull to the goal, so new targets are a matter of
+% all_parameters. The C++ counterpart, with the gradient and Gauss-Newton
+% Hessian in closed form, is mpc_planner/include/mpc_planner/tracking_cost.h.
+%
+% See also two_obstacles_ego.m, FORCES_NLP
+
+clear; clc; close all;
+deg2rad = @(deg) deg/180*pi; % convert degrees into radians
+
+%% Problem dimensions
+model.N = 85;           % horizon length
+model.nvar = 6;         % number of variables
+model.neq  = 4;         % number of equality constraints
+model.nh = 3;           % number of inequality constraint functions
+model.npar = 22;        % number of parameters: 8 of two_obstacles_ego.m, 14 of the tracking cost
+
+%% Objective function, least squares in the tracking parameters
+model.LSobjective = @(z,p) [sqrt(p(15:20)).*(z - p(9:14));
+                            sqrt(p(22))*(z(3)^2 + z(4)^2 - p(21)^2)];
+
+%% Dynamics, i.e. equality constraints
+m=1; I=1; % physical constants of the model
+integrator_stepsize = 0.1;
+continuous_dynamics = @(x,u,p) [x(3)*cos(x(4));  % v*cos(theta)
+                                x(3)*sin(x(4));  % v*sin(theta)
+                                u(1)/p(1);       % F/m
+                                u(2)/p(2)];      % s/I
+model.eq = @(z,p) RK4( z(3:6), z(1:2), continuous_dynamics, integrator_stepsize, p);
+model.E = [zeros(4,2), eye(4)];
+
+%% Inequality constraints
+%             F   s | x  y  v theta
+model.lb = [ -5, -1, -3, -1, 0, -pi];
+model.ub = [ +5, +1,  3,  3, 1, +pi];
+
+% Ellipse around each obstacle, aligned with its heading and stretched with
+% the ego speed, as in two_abstacles.m
+obstacle_ellipse = @(z,o) ((cos(o(3))*(z(3)-o(1))+sin(o(3))*(z(4)-o(2)))^2)/((0.3+z(5))^2) ...
+                        + ((sin(o(3))*(z(3)-o(1))-cos(o(3))*(z(4)-o(2)))^2)/(0.25);
+model.ineq = @(z,p) [z(3)^2 + z(4)^2;
+                     obstacle_ellipse(z, p(3:5));
+                     obstacle_ellipse(z, p(6:8))];
+model.hu = [9,inf,inf];
+model.hl = [2,1,1];
+
+%% Initial conditions
+model.xinit = [-1.5, 0, 0.5, deg2rad(90)]';
+model.xinitidx = 3:6;
+
+%% Define solver options
+codeoptions = getOptions('FORCESNLPsolver_track');
+codeoptions.maxit = 3000;    % Maximum number of iterations
+codeoptions.printlevel = 2;
+codeoptions.optlevel = 2;
+codeoptions.noVariableElimination = 1;
+codeoptions.nlp.lightCasadi = 1;
+codeoptions.nlp.hessian_approximation = 'gauss-newton';
+
+%% Generate forces solver
+FORCES_NLP(model, codeoptions);
+
+%% Predict the obstacles
+% Constant speed and heading from their initial states in two_abstacles.m,
+% the same prediction predict_obstacles (obstacle_predictor.h) does in C++.
+obstacles = [-1, 1.11, 0.1, deg2rad(45);
+             -2, 0,    0.5, deg2rad(90)]';
+obstacle_dynamics = @(x,u,p) [x(3)*cos(x(4)); x(3)*sin(x(4)); 0; 0];
+all_parameters = zeros(8, model.N);
+for k=1:model.N
+    all_parameters(:,k) = [m; I; obstacles([1 2 4],1); obstacles([1 2 4],2)];
+    for i=1:2
+        obstacles(:,i) = RK4(obstacles(:,i), [0 0]', obstacle_dynamics, integrator_stepsize, []);
+    end
+end
+
+%% Tracking references
+% The costs of two_obstacles_ego.m: inputs and lane on every stage, the pull
+% to (1.5, 0) on the last one (lane_reference and goal_reference in C++).
+lane = [zeros(6,1); 0.2; 0.02; 0; 0; 0; 0; 1.5; 0.02];
+goal = [0; 0; 1.5; 0; 0; 0; 0; 0; 200; 200; 0; 0; 0; 0];
+all_parameters = [all_parameters; repmat(lane, 1, model.N)];
+all_parameters(9:22, model.N) = goal;
+
+%% Call solver
+x0i = model.lb+(model.ub-model.lb)/2;
+problem.x0 = repmat(x0i',model.N,1);
+problem.xinit = model.xinit;
+problem.all_parameters = all_parameters(:);
+
+[output,exitflag,info] = FORCESNLPsolver_track(problem);
+fprintf('\nexitflag %d .\n',exitflag);
+fprintf('\nFORCES took %d iterations and %f seconds to solve the problem.\n',info.it,info.solvetime);
+assert(exitflag == 1,'Some problem in FORCES solver');
+
+%% Plot results
+TEMP = zeros(model.nvar,model.N);
+for i=1:model.N
+    TEMP(:,i) = output.(['x',sprintf('%02d',i)]);
+end
+X = TEMP(3:6,:);
+
+figure(1); clf;
+plot(X(1,:),X(2,:),'b.-'); hold on;
+plot(all_parameters(3,:),all_parameters(4,:),'g.');
+plot(all_parameters(6,:),all_parameters(7,:),'m.');
+rectangle('Position',[-sqrt(model.hl(1)) -sqrt(model.hl(1)) 2*sqrt(model.hl(1)) 2*sqrt(model.hl(1))],'Curvature',[1 1],'EdgeColor','r','LineStyle',':');
+rectangle('Position',[-sqrt(model.hu(1)) -sqrt(model.hu(1)) 2*sqrt(model.hu(1)) 2*sqrt(model.hu(1))],'Curvature',[1 1],'EdgeColor','r','LineStyle',':');
+box on
+legend({'autonomous car','obstacle1','obstacle2'},'FontSize',8,'FontWeight','bold','Location','best')
+title('position'); xlim([-3 3]); ylim([0 3]); xlabel('x position'); ylabel('y position');
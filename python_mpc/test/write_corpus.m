@@ -0,0 +1,54 @@
+function write_corpus(filename, problem, output, exitflag, info)
+% WRITE_CORPUS appends a FORCESNLPsolver problem instance to a replay corpus.
+%
+%   write_corpus('scenarios.corpus', problem) writes problem.xinit,
+%   problem.x0 and problem.all_parameters as one record of the corpus format
+%   of FORCESNLPsolver_corpus.h, the input of FORCESNLPsolver_replay (PGO
+%   training run, regression replays). The header is written when the file
+%   is new.
+%
+%   write_corpus('scenarios.corpus', problem, output, exitflag, info) also
+%   stores the result of FORCESNLPsolver(problem) as reference. All records
+%   of a file either have references or not.
+%
+% Call it next to FORCESNLPsolver(problem) in the scenario scripts to record
+% the instances they solve.
+
+nxinit = 12; nx0 = 1530; npar = 170; noutput = 1530;
+reference = nargin >= 5;
+
+record = [problem.xinit(:); problem.x0(:); problem.all_parameters(:)];
+assert(numel(record) == nxinit + nx0 + npar, 'problem does not match FORCESNLPsolver');
+if reference
+    z = zeros(18, 85);
+    for i = 1:85
+        z(:, i) = output.(sprintf('x%02d', i));
+    end
+    assert(numel(z) == noutput, 'output does not match FORCESNLPsolver');
+end
+
+% header, see FORCESNLPsolver_corpus.h
+record_size = 8*(nxinit + nx0 + npar) + reference*(8*noutput + 8);
+header = uint32([1, hex2dec('01020304'), 64, record_size, nxinit, nx0, npar, reference*noutput, reference]);
+
+fid = fopen(filename, 'a+');
+assert(fid ~= -1, ['cannot open ', filename]);
+fseek(fid, 0, 'eof');
+if ftell(fid) == 0
+    fwrite(fid, 'FNLPCORP', 'char');
+    fwrite(fid, header, 'uint32');
+    fwrite(fid, zeros(1, 20), 'uint8');
+else
+    frewind(fid);
+    assert(strcmp(fread(fid, [1 8], '*char'), 'FNLPCORP'), [filename, ' is not a corpus']);
+    existing = fread(fid, [1 9], '*uint32');
+    assert(isequal(existing, header), [filename, ' has another version or record layout']);
+    fseek(fid, 0, 'eof');
+end
+fwrite(fid, record, 'double');
+if reference
+    fwrite(fid, z(:), 'double');
+    fwrite(fid, int32([exitflag, info.it]), 'int32');
+end
+fclose(fid);
+end